@@ -0,0 +1,241 @@
+﻿#pragma once
+#include <string>       // std::string
+#include <vector>       // std::vector
+#include <chrono>       // std::chrono::steady_clock
+#include <iostream>     // std::cout
+#include <iomanip>      // std::setw
+#include <sstream>      // std::ostringstream
+#include <regex>        // std::regex_replace
+#include "MappedFile.h"
+#include "CsvScan.h"
+#include "CsvUtils.h"
+#include "HTML.h"
+
+// Developer microbenchmarks, run with: "Door Program.exe" --bench-csv <file.csv>
+// or "Door Program.exe" --bench-format
+namespace Bench
+{
+    // Repeats work() until at least minSeconds have passed and returns the
+    // best single-run time in seconds.
+    template <typename Fn>
+    double BestOf(Fn&& work, double minSeconds = 0.5)
+    {
+        using clock = std::chrono::steady_clock;
+        double best = 1e30;
+        double total = 0.0;
+        int runs = 0;
+
+        while (total < minSeconds || runs < 3)
+        {
+            auto start = clock::now();
+            work();
+            double seconds = std::chrono::duration<double>(clock::now() - start).count();
+            best = (seconds < best) ? seconds : best;
+            total += seconds;
+            ++runs;
+        }
+        return best;
+    }
+
+    inline void PrintRate(const char* name, size_t bytes, double seconds)
+    {
+        double mbps = (static_cast<double>(bytes) / (1024.0 * 1024.0)) / seconds;
+        std::cout << std::setw(24) << std::left << name
+            << std::setw(10) << std::right << std::fixed << std::setprecision(1) << mbps << " MB/s\n";
+    }
+
+    // Bytes/sec of the CSV record splitter for every kernel this CPU supports,
+    // then of the full CsvReader::Read (mapping + splitting + header lookup).
+    inline void RunCsvScanBenchmark(const std::string& path)
+    {
+        MappedFile file(path);
+        if (!file.IsOpen() || file.Size() == 0)
+        {
+            std::cout << "Cannot read " << path << "\n";
+            return;
+        }
+
+        const std::string_view text = file.Text();
+        std::cout << path << ": " << text.size() << " bytes, default kernel "
+            << CsvScan::KernelName(CsvScan::BestKernel()) << "\n";
+
+        const CsvScan::Kernel kernels[] = { CsvScan::Kernel::Scalar, CsvScan::Kernel::SSE2, CsvScan::Kernel::AVX2 };
+        for (CsvScan::Kernel kernel : kernels)
+        {
+            if (!CsvScan::IsSupported(kernel))
+                continue;
+
+            size_t records = 0;
+            double seconds = BestOf([&]
+                {
+                    std::vector<CsvSpan> fields;
+                    CsvScanner scanner(text, 0, kernel);
+                    records = 0;
+                    while (scanner.Next(fields))
+                        ++records;
+                });
+
+            std::string name = std::string("scan ") + CsvScan::KernelName(kernel);
+            PrintRate(name.c_str(), text.size(), seconds);
+        }
+
+        size_t rows = 0;
+        double seconds = BestOf([&]
+            {
+                CsvTable table = CsvReader::Read(path);
+                rows = table.RowCount();
+            });
+        PrintRate("CsvReader::Read", text.size(), seconds);
+        std::cout << rows << " rows\n";
+    }
+
+    inline void PrintCallTime(const char* name, size_t calls, double seconds, double baseline = 0.0)
+    {
+        std::cout << std::setw(24) << std::left << name
+            << std::setw(10) << std::right << std::fixed << std::setprecision(1) << seconds * 1e9 / static_cast<double>(calls) << " ns/call";
+        if (baseline > 0.0)
+            std::cout << std::setw(8) << std::setprecision(1) << baseline / seconds << "x";
+        std::cout << "\n";
+    }
+
+    // Fraction as it was before the lookup tables, kept to measure against
+    namespace Reference
+    {
+        inline std::string FormatDecimal(double value)
+        {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(4) << value;
+            std::string s = oss.str();
+            s = std::regex_replace(s, std::regex("0+$"), "");
+            if (!s.empty() && s.back() == '.')
+                s.pop_back();
+            return s;
+        }
+
+        // Lengths were printed through their double
+        inline std::string FormatDecimal(Length value)
+        {
+            return FormatDecimal(value.Inches());
+        }
+
+        class Fraction
+        {
+            Length value;
+            int whole = 0;
+            int numerator = 0;
+            int denominator;
+            int direction = 0;
+        public:
+            Fraction(Length val, int denom)
+                : value(val), denominator(denom)
+            {
+                const int64_t rounded = val.Round(denom);
+                whole = static_cast<int>(rounded / denom);
+                numerator = static_cast<int>(rounded % denom);
+                if (numerator != 0)
+                    while (numerator % 2 == 0 && numerator != 0 && denominator != 0)
+                    {
+                        numerator /= 2;
+                        denominator /= 2;
+                    }
+                const int64_t roundedticks = rounded * Length::TicksPerInch;
+                const int64_t ticks = val.Ticks() * denom;
+                if (roundedticks > ticks)
+                    direction++;
+                else if (roundedticks < ticks)
+                    direction--;
+            }
+            std::string GetDecimalString() const
+            {
+                if (value == Length())
+                    return "0\"";
+                return FormatDecimal(value) + "\"";
+            }
+            std::string GetFractionString() const
+            {
+                if (numerator == 0)
+                    return std::to_string(whole) + "\"";
+                else if (whole == 0)
+                    return std::to_string(numerator) + "/" + std::to_string(denominator) + "\"";
+                return std::to_string(whole) + " " + std::to_string(numerator) + "/" + std::to_string(denominator) + "\"";
+            }
+            std::string GetString() const
+            {
+                if (value == Length())
+                    return "0\"";
+                else if (direction == 0 && numerator != 0)
+                    return GetDecimalString() + " (" + GetFractionString() + ")";
+                else if (direction == 0 && numerator == 0)
+                    return GetDecimalString();
+                return GetDecimalString() + " (" + GetFractionString() + ", " + (direction < 0 ? "rounded down" : "rounded up") + ")";
+            }
+        };
+    }
+
+    // Time per number of the Fraction text the reports use, for the
+    // reference class above and for the table-driven one, both returning
+    // strings and writing into a buffer.
+    inline void RunFormatBenchmark()
+    {
+        // Lengths up to 120" in steps that land on and between 1/32"s
+        std::vector<Length> lengths;
+        for (int64_t i = 0; i < 4096; ++i)
+            lengths.push_back(Length::FromTicks(i * 18757));
+        // and odd 32nds, which fall halfway between two 0.0001" steps
+        for (double tie : { 0.03125, 0.15625, 23.15625, -0.03125 })
+            lengths.push_back(Length::FromInches(tie));
+        std::vector<double> values;
+        for (Length length : lengths)
+            values.push_back(length.Inches());
+
+        size_t mismatches = 0;
+        for (Length length : lengths)
+        {
+            if (Reference::Fraction(length, 32).GetString() != Fraction(length, 32).GetString()
+                || Reference::FormatDecimal(length.Inches()) != Fraction::FormatDecimal(length.Inches())
+                || Reference::FormatDecimal(length) != Fraction::FormatDecimal(length))
+                ++mismatches;
+        }
+        std::cout << lengths.size() << " lengths, " << mismatches << " texts differ from the reference\n";
+
+        size_t sink = 0;
+        const double regexDecimal = BestOf([&]
+            {
+                for (double value : values)
+                    sink += Reference::FormatDecimal(value).size();
+            });
+        PrintCallTime("FormatDecimal regex", values.size(), regexDecimal);
+        PrintCallTime("FormatDecimal", values.size(), BestOf([&]
+            {
+                for (double value : values)
+                    sink += Fraction::FormatDecimal(value).size();
+            }), regexDecimal);
+        PrintCallTime("FormatDecimal to_chars", values.size(), BestOf([&]
+            {
+                char buffer[Fraction::MaxDecimalSize];
+                for (double value : values)
+                    sink += Fraction::FormatDecimal(buffer, buffer + sizeof(buffer), value).ptr - buffer;
+            }), regexDecimal);
+
+        const double referenceString = BestOf([&]
+            {
+                for (Length length : lengths)
+                    sink += Reference::Fraction(length, 32).GetString().size();
+            });
+        PrintCallTime("GetString reference", lengths.size(), referenceString);
+        PrintCallTime("GetString", lengths.size(), BestOf([&]
+            {
+                for (Length length : lengths)
+                    sink += Fraction(length, 32).GetString().size();
+            }), referenceString);
+        PrintCallTime("Write", lengths.size(), BestOf([&]
+            {
+                char buffer[Fraction::MaxTextSize];
+                for (Length length : lengths)
+                    sink += Fraction(length, 32).Write(buffer, buffer + sizeof(buffer)).ptr - buffer;
+            }), referenceString);
+
+        if (sink == 0)
+            std::cout << "\n";
+    }
+}
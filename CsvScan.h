@@ -0,0 +1,365 @@
+#pragma once
+#include <string_view>  // std::string_view
+#include <vector>       // std::vector
+#include <cstdint>      // uint64_t, uint32_t
+#include <cstring>      // std::memcpy
+#include <bit>          // std::countr_zero
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define CSV_SCAN_X86 1
+#include <immintrin.h>  // SSE2 / AVX2 intrinsics
+#ifdef _MSC_VER
+#include <intrin.h>     // __cpuidex, _xgetbv
+#endif
+#endif
+
+// GCC/Clang only emit AVX2 code inside functions that ask for it;
+// MSVC accepts the intrinsics anywhere.
+#if defined(CSV_SCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CSV_SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CSV_SCAN_TARGET_AVX2
+#endif
+
+// Location of one raw field inside a CSV text buffer.
+// Quoted fields keep their quotes until CsvTable::Value unescapes them.
+struct CsvSpan
+{
+    uint32_t offset = 0;
+    uint32_t length : 31 = 0;
+    uint32_t quoted : 1 = 0;
+};
+
+namespace CsvScan
+{
+    // Bitmasks for one 64-byte block; bit i describes byte i.
+    struct BlockMasks
+    {
+        uint64_t quotes = 0;
+        uint64_t commas = 0;
+        uint64_t newlines = 0;
+    };
+
+    constexpr size_t BlockSize = 64;
+
+    using BlockFn = BlockMasks(*)(const char* block);
+
+    enum class Kernel
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    inline BlockMasks ScanScalar(const char* block)
+    {
+        BlockMasks m;
+        for (size_t i = 0; i < BlockSize; ++i)
+        {
+            const uint64_t bit = uint64_t(1) << i;
+            switch (block[i])
+            {
+            case '"':  m.quotes |= bit;   break;
+            case ',':  m.commas |= bit;   break;
+            case '\n': m.newlines |= bit; break;
+            default:                      break;
+            }
+        }
+        return m;
+    }
+
+#ifdef CSV_SCAN_X86
+    inline BlockMasks ScanSSE2(const char* block)
+    {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i newline = _mm_set1_epi8('\n');
+
+        BlockMasks m;
+        for (size_t i = 0; i < BlockSize; i += 16)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+            m.quotes |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << i;
+            m.commas |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma)))) << i;
+            m.newlines |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)))) << i;
+        }
+        return m;
+    }
+
+    CSV_SCAN_TARGET_AVX2 inline BlockMasks ScanAVX2(const char* block)
+    {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i newline = _mm256_set1_epi8('\n');
+
+        BlockMasks m;
+        for (size_t i = 0; i < BlockSize; i += 32)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+            m.quotes |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << i;
+            m.commas |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, comma)))) << i;
+            m.newlines |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline)))) << i;
+        }
+        return m;
+    }
+
+    inline bool CpuHasAVX2()
+    {
+#ifdef _MSC_VER
+        int regs[4] = {};
+        __cpuid(regs, 1);
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)   // OS must save YMM state
+            return false;
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    inline bool IsSupported(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case Kernel::Scalar:
+            return true;
+#ifdef CSV_SCAN_X86
+        case Kernel::SSE2:
+            return true;
+        case Kernel::AVX2:
+            return CpuHasAVX2();
+#endif
+        default:
+            return false;
+        }
+    }
+
+    inline BlockFn GetKernel(Kernel kernel)
+    {
+        switch (kernel)
+        {
+#ifdef CSV_SCAN_X86
+        case Kernel::SSE2:
+            return ScanSSE2;
+        case Kernel::AVX2:
+            return ScanAVX2;
+#endif
+        default:
+            return ScanScalar;
+        }
+    }
+
+    // Widest kernel this CPU runs, picked once per process.
+    inline Kernel BestKernel()
+    {
+        static const Kernel best =
+            IsSupported(Kernel::AVX2) ? Kernel::AVX2 :
+            IsSupported(Kernel::SSE2) ? Kernel::SSE2 :
+            Kernel::Scalar;
+        return best;
+    }
+
+    inline const char* KernelName(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case Kernel::Scalar: return "scalar";
+        case Kernel::SSE2:   return "SSE2";
+        case Kernel::AVX2:   return "AVX2";
+        }
+        return "unknown";
+    }
+
+    // Bit i of the result is the XOR of bits 0..i: set for every byte that
+    // sits after an odd number of quotes, i.e. inside a quoted section.
+    inline uint64_t PrefixXor(uint64_t x)
+    {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    // What a worker needs to know about a byte range before it can tell
+    // where its first record begins. The range is scanned once assuming it
+    // starts outside quotes; the "inside" answer falls out of the same pass
+    // because that hypothesis simply inverts the quote state.
+    struct ChunkSummary
+    {
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        bool oddQuotes = false;                 // range flips the quote state
+        size_t firstRecordIfOutside = npos;     // just past the first real newline
+        size_t firstRecordIfInside = npos;
+    };
+
+    inline ChunkSummary SummarizeChunk(std::string_view text, size_t begin, size_t end,
+        Kernel kernel = BestKernel())
+    {
+        const BlockFn scan = GetKernel(kernel);
+        ChunkSummary summary;
+        uint64_t carry = 0;
+
+        for (size_t block = begin; block < end; block += BlockSize)
+        {
+            const size_t count = (end - block < BlockSize) ? end - block : BlockSize;
+            BlockMasks masks;
+
+            if (count == BlockSize)
+            {
+                masks = scan(text.data() + block);
+            }
+            else
+            {
+                char tail[BlockSize] = {};
+                std::memcpy(tail, text.data() + block, count);
+                masks = scan(tail);
+            }
+
+            const uint64_t inside = PrefixXor(masks.quotes) ^ carry;
+            carry = (inside >> 63) ? ~uint64_t(0) : 0;
+
+            const uint64_t outsideNewlines = masks.newlines & ~inside;
+            const uint64_t insideNewlines = masks.newlines & inside;
+
+            if (summary.firstRecordIfOutside == ChunkSummary::npos && outsideNewlines)
+                summary.firstRecordIfOutside = block + std::countr_zero(outsideNewlines) + 1;
+            if (summary.firstRecordIfInside == ChunkSummary::npos && insideNewlines)
+                summary.firstRecordIfInside = block + std::countr_zero(insideNewlines) + 1;
+        }
+
+        summary.oddQuotes = carry != 0;
+        return summary;
+    }
+}
+
+// Block-at-a-time CSV record splitter.
+// Each 64-byte block is reduced to quote/comma/newline bitmasks; the quote
+// mask is turned into an "inside quotes" mask with a prefix XOR (carried
+// across blocks), and only commas and newlines outside quotes are visited.
+// Unquoted fields therefore become plain slices with no per-byte branching.
+class CsvScanner
+{
+public:
+    CsvScanner(std::string_view text, size_t pos = 0,
+        CsvScan::Kernel kernel = CsvScan::BestKernel())
+        : m_text(text), m_scan(CsvScan::GetKernel(kernel)),
+        m_blockStart(pos), m_fieldStart(pos)
+    {
+        if (pos < m_text.size())
+            LoadBlock();
+    }
+
+    // Replaces fields with the spans of the next record. Returns false once
+    // the text is exhausted. A trailing \r before the newline is dropped.
+    bool Next(std::vector<CsvSpan>& fields)
+    {
+        fields.clear();
+        return Next([&](size_t, const CsvSpan& span) { fields.push_back(span); });
+    }
+
+    // Calls sink(column, span) for each field of the next record. Sinks that
+    // ignore most columns let callers skip fields they never read.
+    template <typename Sink>
+    bool Next(Sink&& sink)
+    {
+        if (m_fieldStart >= m_text.size())
+            return false;
+
+        size_t column = 0;
+
+        for (;;)
+        {
+            while (m_structural == 0)
+            {
+                if (m_quotes != 0)
+                    m_fieldQuoted = true;
+
+                m_blockStart += CsvScan::BlockSize;
+                if (m_blockStart >= m_text.size())
+                {
+                    sink(column, Take(m_text.size(), true));
+                    m_fieldStart = m_text.size();
+                    return true;
+                }
+                LoadBlock();
+            }
+
+            const int bit = std::countr_zero(m_structural);
+            const uint64_t below = (uint64_t(1) << bit) - 1;
+            const size_t pos = m_blockStart + static_cast<size_t>(bit);
+
+            if (m_quotes & below)
+                m_fieldQuoted = true;
+            m_quotes &= ~below;
+            m_structural &= m_structural - 1;
+
+            if (m_text[pos] == ',')
+            {
+                sink(column++, Take(pos, false));
+                m_fieldStart = pos + 1;
+            }
+            else
+            {
+                sink(column, Take(pos, true));
+                m_fieldStart = pos + 1;
+                return true;
+            }
+        }
+    }
+
+    // Start of the next unread record.
+    size_t Position() const { return m_fieldStart < m_text.size() ? m_fieldStart : m_text.size(); }
+
+private:
+    void LoadBlock()
+    {
+        CsvScan::BlockMasks masks;
+        const size_t remaining = m_text.size() - m_blockStart;
+
+        if (remaining >= CsvScan::BlockSize)
+        {
+            masks = m_scan(m_text.data() + m_blockStart);
+        }
+        else
+        {
+            char tail[CsvScan::BlockSize] = {};   // NUL padding is never structural
+            std::memcpy(tail, m_text.data() + m_blockStart, remaining);
+            masks = m_scan(tail);
+        }
+
+        const uint64_t inside = CsvScan::PrefixXor(masks.quotes) ^ m_insideCarry;
+        m_insideCarry = (inside >> 63) ? ~uint64_t(0) : 0;
+
+        m_structural = (masks.commas | masks.newlines) & ~inside;
+        m_quotes = masks.quotes;
+    }
+
+    CsvSpan Take(size_t end, bool recordEnd)
+    {
+        if (recordEnd && end > m_fieldStart && m_text[end - 1] == '\r')
+            --end;
+
+        CsvSpan span;
+        span.offset = static_cast<uint32_t>(m_fieldStart);
+        span.length = static_cast<uint32_t>(end - m_fieldStart);
+        span.quoted = m_fieldQuoted;
+
+        m_fieldQuoted = false;
+        return span;
+    }
+
+    std::string_view m_text;
+    CsvScan::BlockFn m_scan;
+    size_t m_blockStart;
+    size_t m_fieldStart;
+    uint64_t m_structural = 0;   // unvisited delimiters in the current block
+    uint64_t m_quotes = 0;       // quotes in the current block not yet attributed to a field
+    uint64_t m_insideCarry = 0;  // all ones when the previous block ended inside quotes
+    bool m_fieldQuoted = false;
+};
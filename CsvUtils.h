@@ -1,31 +1,39 @@
 ﻿#pragma once
 #include <string>        // std::string
+#include <string_view>   // std::string_view
 #include <vector>        // std::vector
 #include <unordered_map>// std::unordered_map
 #include <fstream>       // std::ifstream, std::ofstream
 #include <iostream>      // std::ostream
 #include <algorithm>    // std::transform, std::find_if
 #include <cctype>       // std::isspace, std::toupper
-#include <cstdlib>      // std::strtol, std::strtod
-#include <climits>      // INT_MIN, INT_MAX
-#include <cstring>      // strncpy_s
+#include <charconv>     // std::from_chars
+#include <cstdint>      // uint32_t
 #include <filesystem>   // extractparentFolderName
-#include <shobjidl.h>   // IFileDialog
-#include <corecrt.h>  // errno
-#include <shtypes.h>    // SIGDN_FILESYSPATH
+#include <thread>       // std::thread
+#include <span>         // std::span
+#include <memory_resource> // std::pmr::memory_resource
+#include <type_traits>  // std::is_enum_v
+#include "MappedFile.h"  // MappedFile
+#include "CsvScan.h"     // CsvScanner, CsvSpan
 
 
 //forward declarations
 struct CsvError;
+struct CsvColumn;
+struct CsvSpan;
 struct CsvRow;
 struct CsvTable;
 class CsvReader;
-inline std::string Trim(std::string s);
-inline std::string ToUpper(std::string s);
-inline void CopyCsvText(const CsvRow& row, const char* columnName, char* dst, size_t dstSize);
-inline bool ReadInt(const CsvRow& row, const char* columnName, int& outValue);
-inline bool ReadUInt(const CsvRow& row, const char* columnName, unsigned int& outValue);
-inline bool ReadDouble(const CsvRow& row, const char* columnName, double& outValue);
+inline std::string_view TrimView(std::string_view s);
+inline std::string Trim(std::string_view s);
+inline std::string ToUpper(std::string_view s);
+inline bool ParseInt(std::string_view s, int& outValue);
+inline bool ParseUInt(std::string_view s, unsigned int& outValue);
+inline bool ParseInches(std::string_view s, double& outValue);
+template <typename Column> inline bool ReadInt(const CsvRow& row, Column column, int& outValue);
+template <typename Column> inline bool ReadUInt(const CsvRow& row, Column column, unsigned int& outValue);
+template <typename Column> inline bool ReadDouble(const CsvRow& row, Column column, double& outValue);
 inline std::string extractparentFolderName(const std::string& fullPath);
 inline void WriteField(std::ostream& os, const char* s);
 
@@ -35,125 +43,318 @@ struct CsvError
     std::string message;
 };
 
+// One entry of a compile-time column list. Reading with a schema projects the
+// file onto these columns: row[i] is schema column i, whatever its position
+// in the file, and file columns outside the schema are skipped while scanning.
+struct CsvColumn
+{
+    std::string_view name;
+    bool required = false;
+};
+
+using CsvSchema = std::span<const CsvColumn>;
+
+// Lightweight view of one record; valid as long as its CsvTable.
 struct CsvRow
 {
-    std::unordered_map<std::string, std::string> fields;
+    CsvRow(const CsvTable& table, const CsvSpan* fields)
+        : m_table(&table), m_fields(fields)
+    {}
+
+    inline std::string_view operator[](size_t column) const;
 
-    const std::string& operator[](const std::string& key) const
+    // Index by a schema's column enum
+    template <typename Column>
+        requires std::is_enum_v<Column>
+    std::string_view operator[](Column column) const
     {
-        static const std::string empty;
-        auto it = fields.find(key);
-        return (it != fields.end()) ? it->second : empty;
+        return (*this)[static_cast<size_t>(column)];
     }
+
+    // Compatibility accessor for row["Name"]; prefer resolving the column once
+    // with CsvTable::ColumnIndex and indexing by number.
+    inline std::string_view operator[](std::string_view name) const;
+
+private:
+    const CsvTable* m_table;
+    const CsvSpan* m_fields;
 };
 
+// Columnar CSV table. Headers are resolved to column indices once; every row
+// is a fixed-width run of CsvSpans into the memory-mapped file, so rows cost no
+// allocations of their own. Quoted fields are unescaped on first access into a
+// side buffer owned by the table, so returned string_views live as long as it.
+// The headers, spans and that buffer come from the table's memory resource.
 struct CsvTable
 {
-    std::vector<std::string> headers;
-    std::vector<CsvRow> rows;
-};
+    static constexpr size_t npos = static_cast<size_t>(-1);
 
-class CsvFileDialog
-{
-public:
-    inline static std::string Open();
+    explicit CsvTable(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : headers(memory), m_fields(memory), m_columns(memory), m_unescaped(memory)
+    {}
+
+    std::pmr::vector<std::pmr::string> headers;
+
+    size_t RowCount() const { return m_rowCount; }
+    size_t ColumnCount() const { return headers.size(); }
+
+    CsvRow Row(size_t index) const
+    {
+        return CsvRow(*this, m_fields.data() + index * headers.size());
+    }
+
+    size_t ColumnIndex(std::string_view name) const
+    {
+        auto it = m_columns.find(name);
+        return (it != m_columns.end()) ? it->second : npos;
+    }
+
+    inline std::string_view Value(const CsvSpan& field) const;
+
+    // Whether the table was read projected onto this schema
+    bool HasSchema(CsvSchema schema) const
+    {
+        return m_schema.data() == schema.data() && m_schema.size() == schema.size();
+    }
+
+    // Required schema columns the file's header row does not have
+    const std::vector<std::string_view>& MissingColumns() const { return m_missing; }
+
+private:
+    friend class CsvReader;
+
+    static constexpr uint32_t SkipColumn = UINT32_MAX;
+
+    struct NameHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    MappedFile m_file;
+    std::string_view m_text;
+    std::pmr::vector<CsvSpan> m_fields;  // RowCount() * ColumnCount(), row-major
+    size_t m_rowCount = 0;
+    std::pmr::unordered_map<std::pmr::string, size_t, NameHash, std::equal_to<>> m_columns;
+    std::vector<uint32_t> m_slots;   // file column -> table column, or SkipColumn
+    CsvSchema m_schema;
+    std::vector<std::string_view> m_missing;
+    mutable std::pmr::unordered_map<uint32_t, std::pmr::string> m_unescaped; // keyed by CsvSpan::offset
 };
 
 class CsvReader
 {
 public:
-    static CsvTable Read(const std::string& path);
+    // threads == 0 uses every hardware thread; small files are always read
+    // on the calling thread. The table allocates from memory, which only
+    // the calling thread uses.
+    static CsvTable Read(const std::string& path, unsigned int threads = 0,
+        std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    // Reads only the schema's columns. If a required one is missing from the
+    // header row no rows are read; see CsvTable::MissingColumns.
+    static CsvTable Read(const std::string& path, CsvSchema schema, unsigned int threads = 0,
+        std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    // Streams the data rows to onRow(const CsvRow& row, size_t index) as they
+    // are split, without keeping them; index is 0-based and the row is only
+    // valid during the call. Returns false if the file cannot be read.
+    template <typename Fn>
+    static bool ForEachRow(const std::string& path, Fn&& onRow);
+
+    // Streams the rows projected onto the schema. Returns false, with the
+    // absent names in missing, if a required column is not in the header row.
+    // Headers and unescaped fields are kept in memory.
+    template <typename Fn>
+    static bool ForEachRow(const std::string& path, CsvSchema schema,
+        std::vector<std::string_view>& missing, Fn&& onRow,
+        std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
 private:
-    static std::vector<std::string> ParseLine(const std::string& line);
-};
+    friend struct CsvTable;
 
+    static bool OpenTable(const std::string& path, CsvSchema schema, CsvTable& table, size_t& dataStart);
 
-inline std::string Trim(std::string s)
-{
-    auto not_space = [](unsigned char c) { return !std::isspace(c); };
+    static constexpr size_t MinChunkBytes = 4 * 1024 * 1024;
+
+    static std::pmr::string Unescape(std::string_view raw, std::pmr::memory_resource* memory);
+    static std::vector<size_t> FindRecordStarts(std::string_view text, size_t begin, size_t chunks);
+    static size_t SplitRecords(std::string_view text, size_t begin, size_t end,
+        const std::vector<uint32_t>& slots, size_t columns, std::pmr::vector<CsvSpan>& out);
+};
 
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), not_space));
-    s.erase(std::find_if(s.rbegin(), s.rend(), not_space).base(), s.end());
 
+inline std::string_view TrimView(std::string_view s)
+{
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front())))
+        s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back())))
+        s.remove_suffix(1);
     return s;
 }
 
-inline std::string ToUpper(std::string s)
+inline std::string Trim(std::string_view s)
+{
+    return std::string(TrimView(s));
+}
+
+inline std::string ToUpper(std::string_view v)
 {
-    s = Trim(s);
+    std::string s = Trim(v);
     std::transform(s.begin(), s.end(), s.begin(),
         [](unsigned char c) { return std::toupper(c); });
     return s;
 }
 
-inline void CopyCsvText(const CsvRow& row, const char* columnName, char* dst, size_t dstSize)
+// Numeric parsers work on the field in place: no NUL terminator, no locale,
+// no allocation. Surrounding whitespace is ignored; anything else left over
+// makes the field invalid.
+
+// Drops a leading '+', which from_chars does not take. False if nothing
+// but a sign is left, or if another sign follows, since from_chars would
+// read "+-5" as -5.
+inline bool StripPlusSign(std::string_view& s)
 {
-    const std::string& value = row[columnName];
-    strncpy_s(dst, dstSize, value.c_str(), _TRUNCATE);
+    if (!s.empty() && s.front() == '+')
+    {
+        s.remove_prefix(1);
+        if (!s.empty() && (s.front() == '+' || s.front() == '-'))
+            return false;
+    }
+    return !s.empty();
 }
 
-inline bool ReadInt(const CsvRow& row, const char* columnName, int& outValue)
+inline bool ParseInt(std::string_view s, int& outValue)
 {
-    const std::string& s = row[columnName];
-
-    if (s.empty())
+    s = TrimView(s);
+    if (!StripPlusSign(s))
         return false;
 
-    char* end = nullptr;
-    errno = 0;
+    int v = 0;
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc() || end != s.data() + s.size())
+        return false;
 
-    long v = std::strtol(s.c_str(), &end, 10);
+    outValue = v;
+    return true;
+}
 
-    if (errno != 0 || end == s.c_str() || *end != '\0')
+inline bool ParseUInt(std::string_view s, unsigned int& outValue)
+{
+    s = TrimView(s);
+    if (!StripPlusSign(s))
         return false;
 
-    if (v < INT_MIN || v > static_cast<long>(INT_MAX))
+    unsigned int v = 0;
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc() || end != s.data() + s.size())
         return false;
 
-    outValue = static_cast<int>(v);
+    outValue = v;
     return true;
 }
 
-inline bool ReadUInt(const CsvRow& row, const char* columnName, unsigned int& outValue)
+// Parses a length in inches the way estimators type it:
+//   decimal         "23.4375"  ".5"
+//   mixed fraction  "23 7/16"  "15-1/2"
+//   simple fraction "7/16"
+// with an optional sign and an optional trailing inch mark (").
+inline bool ParseInches(std::string_view s, double& outValue)
 {
-    const std::string& s = row[columnName];
+    s = TrimView(s);
+    if (!s.empty() && s.back() == '"')
+        s = TrimView(s.substr(0, s.size() - 1));
 
-    if (s.empty())
+    bool negative = false;
+    if (!s.empty() && (s.front() == '-' || s.front() == '+'))
+    {
+        negative = (s.front() == '-');
+        s.remove_prefix(1);
+    }
+    if (s.empty() || s.front() == '-' || s.front() == '+')
         return false;
 
-    char* end = nullptr;
-    errno = 0;
+    const char* first = s.data();
+    const char* last = s.data() + s.size();
 
-    unsigned long v = std::strtoul(s.c_str(), &end, 10);
+    auto finish = [&](double v)
+        {
+            outValue = negative ? -v : v;
+            return true;
+        };
 
-    if (errno != 0 || end == s.c_str() || *end != '\0')
-        return false;
+    // numerator "/" denominator, running to the end of the field
+    auto parseFraction = [&](const char* from, double& v)
+        {
+            unsigned int num = 0;
+            unsigned int den = 0;
+            auto [slash, ec1] = std::from_chars(from, last, num);
+            if (ec1 != std::errc() || slash == last || *slash != '/')
+                return false;
+            auto [end, ec2] = std::from_chars(slash + 1, last, den);
+            if (ec2 != std::errc() || end != last || den == 0)
+                return false;
+            v = static_cast<double>(num) / static_cast<double>(den);
+            return true;
+        };
 
-    if (v > UINT_MAX)
-        return false;
+    unsigned long long whole = 0;
+    auto [afterWhole, ec] = std::from_chars(first, last, whole);
 
-    outValue = static_cast<unsigned int>(v);
-    return true;
-}
+    if (ec == std::errc())
+    {
+        if (afterWhole == last)
+            return finish(static_cast<double>(whole));
 
-inline bool ReadDouble(const CsvRow& row, const char* columnName, double& outValue)
-{
-    const std::string& s = row[columnName];
+        // "7/16"
+        if (*afterWhole == '/')
+        {
+            double v = 0.0;
+            return parseFraction(first, v) && finish(v);
+        }
 
-    if (s.empty())
-        return false;
+        // "23 7/16", "15-1/2", "15 - 1/2"
+        if (*afterWhole == ' ' || *afterWhole == '-')
+        {
+            const char* p = afterWhole;
+            while (p != last && *p == ' ')
+                ++p;
+            if (p != last && *p == '-')
+                ++p;
+            while (p != last && *p == ' ')
+                ++p;
+
+            double v = 0.0;
+            return p != last && parseFraction(p, v) && finish(static_cast<double>(whole) + v);
+        }
+    }
 
-    char* end = nullptr;
-    errno = 0;
+    // plain decimal
+    double v = 0.0;
+    auto [end, ecd] = std::from_chars(first, last, v);
+    if (ecd != std::errc() || end != last)
+        return false;
+    return finish(v);
+}
 
-    double v = std::strtod(s.c_str(), &end);
+template <typename Column>
+inline bool ReadInt(const CsvRow& row, Column column, int& outValue)
+{
+    return ParseInt(row[column], outValue);
+}
 
-    if (errno != 0 || end == s.c_str() || *end != '\0')
-        return false;
+template <typename Column>
+inline bool ReadUInt(const CsvRow& row, Column column, unsigned int& outValue)
+{
+    return ParseUInt(row[column], outValue);
+}
 
-    outValue = v;
-    return true;
+// Every double in the door export is a length, so fractional inch notation
+// is accepted wherever a number is.
+template <typename Column>
+inline bool ReadDouble(const CsvRow& row, Column column, double& outValue)
+{
+    return ParseInches(row[column], outValue);
 }
 
 inline std::string extractparentFolderName(const std::string& fullPath)
@@ -165,24 +366,23 @@ inline std::string extractparentFolderName(const std::string& fullPath)
 
 // NOTE:
 // This CSV parser assumes:
-// - One record per line
-// - No multiline fields
 // - LibreOffice / internally generated CSVs
+// - Records end in \n or \r\n; newlines inside quotes stay in the field
 // Escaped quotes ("") ARE supported.
 
-inline std::vector<std::string> CsvReader::ParseLine(const std::string& line)
+inline std::pmr::string CsvReader::Unescape(std::string_view raw, std::pmr::memory_resource* memory)
 {
-    std::vector<std::string> result;
-    std::string field;
+    std::pmr::string field(memory);
+    field.reserve(raw.size());
     bool inQuotes = false;
 
-    for (size_t i = 0; i < line.size(); ++i)
+    for (size_t i = 0; i < raw.size(); ++i)
     {
-        char c = line[i];
+        char c = raw[i];
 
         if (c == '"')
         {
-            if (inQuotes && i + 1 < line.size() && line[i + 1] == '"')
+            if (inQuotes && i + 1 < raw.size() && raw[i + 1] == '"')
             {
                 field += '"';  // escaped quote
                 ++i;           // skip second quote
@@ -192,144 +392,304 @@ inline std::vector<std::string> CsvReader::ParseLine(const std::string& line)
                 inQuotes = !inQuotes;
             }
         }
-        else if (c == ',' && !inQuotes)
-        {
-            result.push_back(field);
-            field.clear();
-        }
         else
         {
             field += c;
         }
     }
 
-    result.push_back(field);
-    return result;
+    return field;
 }
 
-inline CsvTable CsvReader::Read(const std::string& path)
+inline std::string_view CsvTable::Value(const CsvSpan& field) const
 {
-    CsvTable table;
-    std::ifstream file(path);
+    std::string_view raw = m_text.substr(field.offset, field.length);
+    if (!field.quoted)
+        return raw;
 
-    if (!file.is_open())
-        return table;
+    // "plain quoted" needs no copy, just drop the outer quotes
+    if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"')
+    {
+        std::string_view inner = raw.substr(1, raw.size() - 2);
+        if (inner.find('"') == std::string_view::npos)
+            return inner;
+    }
 
-    std::string line;
+    auto it = m_unescaped.find(field.offset);
+    if (it == m_unescaped.end())
+        it = m_unescaped.emplace(field.offset, CsvReader::Unescape(raw, m_unescaped.get_allocator().resource())).first;
+    return it->second;
+}
 
-    // 1) Read header row
-    if (!std::getline(file, line))
-        return table;
+inline std::string_view CsvRow::operator[](size_t column) const
+{
+    if (column >= m_table->ColumnCount())
+        return {};
+    return m_table->Value(m_fields[column]);
+}
 
-    table.headers = ParseLine(line);
+inline std::string_view CsvRow::operator[](std::string_view name) const
+{
+    return (*this)[m_table->ColumnIndex(name)];
+}
+
+// Splits [begin, end) into about `chunks` ranges that each start on a record.
+// Pass 1 summarizes every range in parallel under both quote hypotheses; a
+// running XOR of the quote parities then says which hypothesis holds for
+// each range, and so where its first real record begins. Ranges with no
+// usable newline are merged into their predecessor. The result always starts
+// with begin and ends with text.size().
+inline std::vector<size_t> CsvReader::FindRecordStarts(std::string_view text, size_t begin, size_t chunks)
+{
+    const size_t size = text.size();
+    const size_t step = (size - begin) / chunks;
+
+    std::vector<CsvScan::ChunkSummary> summaries(chunks);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks);
 
-    // 2) Read data rows
-    while (std::getline(file, line))
+    for (size_t i = 0; i < chunks; ++i)
     {
-        auto values = ParseLine(line);
-        CsvRow row;
+        size_t from = begin + i * step;
+        size_t to = (i + 1 == chunks) ? size : from + step;
+        workers.emplace_back([&, i, from, to] { summaries[i] = CsvScan::SummarizeChunk(text, from, to); });
+    }
+    for (auto& worker : workers)
+        worker.join();
 
-        for (size_t i = 0; i < table.headers.size(); ++i)
-        {
-            std::string value;
-            if (i < values.size())
-                value = values[i];
+    std::vector<size_t> starts { begin };
+    bool inside = false;
+
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        const CsvScan::ChunkSummary& summary = summaries[i];
 
-            row.fields[table.headers[i]] = value;
+        // chunk 0 starts at the first data record already
+        if (i > 0)
+        {
+            size_t start = inside ? summary.firstRecordIfInside : summary.firstRecordIfOutside;
+            if (start != CsvScan::ChunkSummary::npos && start < size)
+                starts.push_back(start);
         }
 
-        table.rows.push_back(std::move(row));
+        inside ^= summary.oddQuotes;
     }
 
-    return table;
+    starts.push_back(size);
+    return starts;
 }
 
-//inline std::string CsvFileDialog::Open()
-//{
-//    char fileName[MAX_PATH] = "";
-//
-//    char cwd[MAX_PATH];
-//    GetCurrentDirectoryA(MAX_PATH, cwd);
-//
-//    printf("CWD: %s\n", cwd);
-//
-//    OPENFILENAMEA ofn {};
-//    ofn.lStructSize = sizeof(ofn);
-//    ofn.lpstrFilter =
-//        "CSV Files (*.csv)\0*.csv\0"
-//        "All Files (*.*)\0*.*\0";
-//    ofn.lpstrFile = fileName;
-//    ofn.lpstrInitialDir = cwd;
-//    ofn.nMaxFile = MAX_PATH;
-//    ofn.Flags = OFN_EXPLORER | OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST | OFN_NOCHANGEDIR;
-//    ofn.lpstrDefExt = "csv";
-//
-//    if (GetOpenFileNameA(&ofn))
-//        return fileName;
-//
-//    return {};
-//}
-
-inline std::string CsvFileDialog::Open()
+// Appends the records in [begin, end) as fixed-width rows of `columns` spans,
+// storing each file column in the table column `slots` maps it to. Short rows
+// are padded with empty fields; extra and unprojected fields are dropped.
+// Returns the number of rows appended.
+inline size_t CsvReader::SplitRecords(std::string_view text, size_t begin, size_t end,
+    const std::vector<uint32_t>& slots, size_t columns, std::pmr::vector<CsvSpan>& out)
 {
-    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
-    bool comInitialized = SUCCEEDED(hr);
+    CsvScanner scanner(text.substr(0, end), begin);
+    size_t rows = 0;
 
-    IFileDialog* pfd = nullptr;
-    std::string result;
-
-    if (SUCCEEDED(CoCreateInstance(CLSID_FileOpenDialog, nullptr,
-        CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&pfd))))
+    for (;;)
     {
-        // Build a filter: CSV + All files
-        COMDLG_FILTERSPEC filters[] =
-        {
-            { L"CSV Files (*.csv)", L"*.csv" },
-            { L"All Files (*.*)",   L"*.*"   }
-        };
-        pfd->SetFileTypes(2, filters);
-        pfd->SetDefaultExtension(L"csv");
-        pfd->SetTitle(L"Select CSV File");
+        const size_t base = out.size();
+        out.resize(base + columns);
+        CsvSpan* row = out.data() + base;
 
-        // Get CWD as wide string
-        wchar_t cwd[MAX_PATH];
-        GetCurrentDirectoryW(MAX_PATH, cwd);
+        bool more = scanner.Next([&](size_t column, const CsvSpan& span)
+            {
+                if (column < slots.size() && slots[column] != CsvTable::SkipColumn)
+                    row[slots[column]] = span;
+            });
 
-        IShellItem* folder = nullptr;
-        if (SUCCEEDED(SHCreateItemFromParsingName(cwd, nullptr, IID_PPV_ARGS(&folder))))
+        if (!more)
         {
-            pfd->SetDefaultFolder(folder);
-            pfd->SetFolder(folder);
-            folder->Release();
+            out.resize(base);
+            return rows;
         }
+        ++rows;
+    }
+}
+
+// Maps the file and reads the header row, resolving each name to its table
+// column once. Without a schema every file column is kept and a repeated
+// header name resolves to its last column; with one, the table columns are
+// the schema's, in schema order.
+inline bool CsvReader::OpenTable(const std::string& path, CsvSchema schema, CsvTable& table, size_t& dataStart)
+{
+    if (!table.m_file.Open(path))
+        return false;
+
+    // CsvSpan offsets are 32-bit
+    if (table.m_file.Size() > UINT32_MAX)
+        return false;
 
-        if (SUCCEEDED(pfd->Show(nullptr)))
+    const std::string_view text = table.m_file.Text();
+    if (text.empty())
+        return false;
+
+    table.m_text = text;
+
+    std::vector<CsvSpan> fields;
+    CsvScanner scanner(text);
+    scanner.Next(fields);
+    dataStart = scanner.Position();
+
+    if (schema.empty())
+    {
+        table.headers.reserve(fields.size());
+        table.m_slots.reserve(fields.size());
+        for (size_t i = 0; i < fields.size(); ++i)
         {
-            IShellItem* psi = nullptr;
-            if (SUCCEEDED(pfd->GetResult(&psi)))
-            {
-                PWSTR path = nullptr;
-                if (SUCCEEDED(psi->GetDisplayName(SIGDN_FILESYSPATH, &path)))
-                {
-                    // convert wide → std::string
-                    int size = WideCharToMultiByte(CP_UTF8, 0, path, -1, nullptr, 0, nullptr, nullptr);
-                    std::string utf8(size - 1, 0);
-                    WideCharToMultiByte(CP_UTF8, 0, path, -1, utf8.data(), size, nullptr, nullptr);
-                    result = utf8;
-
-                    CoTaskMemFree(path);
-                }
-                psi->Release();
-            }
+            table.headers.emplace_back(table.Value(fields[i]));
+            table.m_columns[table.headers.back()] = i;
+            table.m_slots.push_back(static_cast<uint32_t>(i));
         }
+        return true;
+    }
+
+    table.m_schema = schema;
+    table.headers.reserve(schema.size());
+    for (size_t i = 0; i < schema.size(); ++i)
+    {
+        table.headers.emplace_back(schema[i].name);
+        table.m_columns[table.headers.back()] = i;
+    }
 
-        pfd->Release();
+    // schema column -> last file column with that name
+    std::vector<size_t> source(schema.size(), CsvTable::npos);
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        auto it = table.m_columns.find(table.Value(fields[i]));
+        if (it != table.m_columns.end())
+            source[it->second] = i;
+    }
+
+    table.m_slots.assign(fields.size(), CsvTable::SkipColumn);
+    for (size_t i = 0; i < schema.size(); ++i)
+    {
+        if (source[i] != CsvTable::npos)
+            table.m_slots[source[i]] = static_cast<uint32_t>(i);
+        else if (schema[i].required)
+            table.m_missing.push_back(schema[i].name);
     }
 
-    if (comInitialized)
-        CoUninitialize();
+    return true;
+}
+
+template <typename Fn>
+inline bool CsvReader::ForEachRow(const std::string& path, Fn&& onRow)
+{
+    std::vector<std::string_view> missing;
+    return ForEachRow(path, CsvSchema(), missing, std::forward<Fn>(onRow));
+}
+
+template <typename Fn>
+inline bool CsvReader::ForEachRow(const std::string& path, CsvSchema schema,
+    std::vector<std::string_view>& missing, Fn&& onRow, std::pmr::memory_resource* memory)
+{
+    // A table with no rows: it owns the mapping, the header index and the
+    // unescape buffer the streamed rows point into.
+    CsvTable table(memory);
+    size_t dataStart = 0;
 
-    return result;
+    if (!OpenTable(path, schema, table, dataStart))
+        return false;
+
+    missing = table.m_missing;
+    if (!missing.empty())
+        return false;
+
+    const size_t columns = table.headers.size();
+    const std::vector<uint32_t>& slots = table.m_slots;
+    CsvScanner scanner(table.m_text, dataStart);
+    std::vector<CsvSpan> fields(columns);
+    size_t index = 0;
+
+    auto store = [&](size_t column, const CsvSpan& span)
+        {
+            if (column < slots.size() && slots[column] != CsvTable::SkipColumn)
+                fields[slots[column]] = span;
+        };
+
+    for (;;)
+    {
+        std::fill(fields.begin(), fields.end(), CsvSpan());
+        if (!scanner.Next(store))
+            break;
+
+        onRow(CsvRow(table, fields.data()), index++);
+        table.m_unescaped.clear();
+    }
+
+    return true;
+}
+
+inline CsvTable CsvReader::Read(const std::string& path, unsigned int threads, std::pmr::memory_resource* memory)
+{
+    return Read(path, CsvSchema(), threads, memory);
+}
+
+inline CsvTable CsvReader::Read(const std::string& path, CsvSchema schema, unsigned int threads, std::pmr::memory_resource* memory)
+{
+    CsvTable table(memory);
+    size_t dataStart = 0;
+
+    if (!OpenTable(path, schema, table, dataStart))
+        return table;
+
+    if (!table.m_missing.empty())
+        return table;
+
+    // Read data rows, in parallel chunks for big files. Chunks are merged
+    // back in file order, so row i is still CSV line i + 2.
+    const std::string_view text = table.m_text;
+    const size_t columns = table.headers.size();
+
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    size_t chunks = (text.size() - dataStart) / MinChunkBytes;
+    if (chunks > threads)
+        chunks = threads;
+
+    if (chunks < 2)
+    {
+        table.m_rowCount = SplitRecords(text, dataStart, text.size(), table.m_slots, columns, table.m_fields);
+        return table;
+    }
+
+    const std::vector<size_t> starts = FindRecordStarts(text, dataStart, chunks);
+    const size_t ranges = starts.size() - 1;
+
+    // Workers must not share the table's resource, so their parts use the heap
+    std::vector<std::pmr::vector<CsvSpan>> parts(ranges);
+    std::vector<size_t> rows(ranges);
+    std::vector<std::thread> workers;
+    workers.reserve(ranges);
+
+    for (size_t i = 0; i < ranges; ++i)
+    {
+        workers.emplace_back([&, i]
+            {
+                rows[i] = SplitRecords(text, starts[i], starts[i + 1], table.m_slots, columns, parts[i]);
+            });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    size_t total = 0;
+    for (const auto& part : parts)
+        total += part.size();
+    table.m_fields.reserve(total);
+
+    for (size_t i = 0; i < ranges; ++i)
+    {
+        table.m_fields.insert(table.m_fields.end(), parts[i].begin(), parts[i].end());
+        table.m_rowCount += rows[i];
+        std::pmr::vector<CsvSpan>().swap(parts[i]);
+    }
+
+    return table;
 }
 
 class Row
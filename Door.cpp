@@ -1,4 +1,4 @@
-#include "Door.h"
+﻿#include "Door.h"
 #include "HTML.h"
 #include <chrono>
 #include <iomanip>
@@ -8,35 +8,48 @@
 #include <map>
 #include <fstream>
 #include <string>
+#include <utility>
 #include <iostream>
 #include <filesystem>
-#include <corecrt.h> // errno
 #include <unordered_map> // std::unordered_map
+#include <cstring>
 #include <functional>
 #include <cstdio>
+#include <thread>
+#include <barrier>
+#include <optional>
+#include <algorithm>
+#include <memory_resource>
 #include "CsvUtils.h"
+#include "Platform.h"
 
-bool Door::Create(const CsvRow& row, size_t row_index, std::vector<CsvError>& errors)
+bool Door::Create(const CsvRow& row, size_t row_index, std::vector<CsvError>& errors, std::vector<CsvError>& warnings)
 {
-    auto fatal = [&](const std::string name_, const std::string label_, const std::string& msg)
+    auto fatal = [&](std::string_view name_, std::string_view label_, const std::string& msg)
         {
-            std::string error = name_ + " " + label_ + " " + msg;
+            std::string error = std::string(name_) + " " + std::string(label_) + " " + msg;
             errors.push_back({ row_index, error });
             return false;
         };
+    auto copyText = [&](DoorColumn column, std::string_view field, DoorString& out)
+        {
+            if (!out.Assign(row[column]))
+                warnings.push_back({ row_index, std::string(field) + " is longer than " + std::to_string(DoorString::Capacity)
+                    + " characters, cut to \"" + std::string(out.View()) + "\"" });
+        };
 
-    CopyCsvText(row, "Name", name, MAXTEXTSIZE);
-    CopyCsvText(row, "Cab#", label, MAXTEXTSIZE);
-    CopyCsvText(row, "Notes", notes, MAXTEXTSIZE);
-    CopyCsvText(row, "Material", material, MAXTEXTSIZE);
+    copyText(DoorColumn::Name, "Name", name);
+    copyText(DoorColumn::CabNumber, "Cab#", label);
+    copyText(DoorColumn::Notes, "Notes", notes);
+    copyText(DoorColumn::Material, "Material", material);
 
-    if (!ReadUInt(row, "Count", quantity) || quantity == 0)
+    if (!ReadUInt(row, DoorColumn::Count, quantity) || quantity == 0)
         return fatal(name, label, "Invalid or missing Count");
 
-    if (!ReadDouble(row, "Actual Width", dimensions.finishedWidth))
+    if (!ReadLength(row, DoorColumn::ActualWidth, dimensions.finishedWidth))
         return fatal(name, label, "Missing or invalid Actual Width");
 
-    if (!ReadDouble(row, "Actual Height", dimensions.finishedHeight))
+    if (!ReadLength(row, DoorColumn::ActualHeight, dimensions.finishedHeight))
         return fatal(name, label, "Missing or invalid Actual Height");
 
     if (!ReadFaceType(row, type))
@@ -46,23 +59,24 @@ bool Door::Create(const CsvRow& row, size_t row_index, std::vector<CsvError>& er
         return fatal(name, label, "Invalid or missing Construction");
 
     // Non-fatal defaults
-    ReadDouble(row, "WidthOversize", dimensions.oversizeWidth);
-    ReadDouble(row, "HeightOversize", dimensions.oversizeHeight);
-    ReadDouble(row, "Rabbet", dimensions.shakerparts.rabbet);
-    ReadDouble(row, "Bone Detail", dimensions.bonedetail);
+    ReadLength(row, DoorColumn::WidthOversize, dimensions.oversizeWidth);
+    ReadLength(row, DoorColumn::HeightOversize, dimensions.oversizeHeight);
+    ReadLength(row, DoorColumn::Rabbet, dimensions.shakerparts.rabbet);
+    ReadLength(row, DoorColumn::BoneDetail, dimensions.bonedetail);
 
-    ReadDouble(row, "Bottom Rail", dimensions.shakerparts.width[static_cast<int>(ShakerPart::BOTTOM_RAIL)]);
-    ReadDouble(row, "Top Rail", dimensions.shakerparts.width[static_cast<int>(ShakerPart::TOP_RAIL)]);
-    ReadDouble(row, "Left Stile", dimensions.shakerparts.width[static_cast<int>(ShakerPart::LEFT_STILE)]);
-    ReadDouble(row, "Right Stile", dimensions.shakerparts.width[static_cast<int>(ShakerPart::RIGHT_STILE)]);
-    ReadDouble(row, "Mid Rail/Stile", dimensions.shakerparts.width[static_cast<int>(ShakerPart::MID_RAIL)]);
-    ReadDouble(row, "Mid Rail/Stile", dimensions.shakerparts.width[static_cast<int>(ShakerPart::MID_STILE)]);
+    ReadLength(row, DoorColumn::BottomRail, dimensions.shakerparts.width[static_cast<int>(ShakerPart::BOTTOM_RAIL)]);
+    ReadLength(row, DoorColumn::TopRail, dimensions.shakerparts.width[static_cast<int>(ShakerPart::TOP_RAIL)]);
+    ReadLength(row, DoorColumn::LeftStile, dimensions.shakerparts.width[static_cast<int>(ShakerPart::LEFT_STILE)]);
+    ReadLength(row, DoorColumn::RightStile, dimensions.shakerparts.width[static_cast<int>(ShakerPart::RIGHT_STILE)]);
+    // One column sizes both mid parts
+    if (ReadLength(row, DoorColumn::MidRailStile, dimensions.shakerparts.width[static_cast<int>(ShakerPart::MID_RAIL)]))
+        dimensions.shakerparts.width[static_cast<int>(ShakerPart::MID_STILE)] = dimensions.shakerparts.width[static_cast<int>(ShakerPart::MID_RAIL)];
 
-    ReadDouble(row, "StickTolerance", dimensions.shakerparts.stick_tolerance);
-    ReadDouble(row, "CopeTolerance", dimensions.shakerparts.cope_tolerance);
+    ReadLength(row, DoorColumn::StickTolerance, dimensions.shakerparts.stick_tolerance);
+    ReadLength(row, DoorColumn::CopeTolerance, dimensions.shakerparts.cope_tolerance);
 
-    ReadUInt(row, "Mid Rail Count", dimensions.shakerparts.mid_rail_count);
-    ReadUInt(row, "Mid Stile Count", dimensions.shakerparts.mid_stile_count);
+    ReadUInt(row, DoorColumn::MidRailCount, dimensions.shakerparts.mid_rail_count);
+    ReadUInt(row, DoorColumn::MidStileCount, dimensions.shakerparts.mid_stile_count);
 
     ReadOrientation(row, dimensions.panel.orientation);
     ReadPanel(row, dimensions.panel.hasPanel);
@@ -70,106 +84,6 @@ bool Door::Create(const CsvRow& row, size_t row_index, std::vector<CsvError>& er
     return true;
 }
 
-double Door::GetRail_Stile_Total_Length() const
-{
-    if (construction == Construction::Slab)
-        return 0.0;
-    const double w = dimensions.GetOversizedWidth();
-    const double h = dimensions.GetOversizedHeight();
-    double total = 0.0;
-    total += dimensions.shakerparts.GetCutLength(construction, ShakerPart::TOP_RAIL, w, h);
-    total += dimensions.shakerparts.GetCutLength(construction, ShakerPart::BOTTOM_RAIL, w, h);
-    total += dimensions.shakerparts.GetCutLength(construction, ShakerPart::LEFT_STILE, w, h);
-    total += dimensions.shakerparts.GetCutLength(construction, ShakerPart::RIGHT_STILE, w, h);
-    if (construction == Construction::Shaker)
-    {
-        total += dimensions.shakerparts.GetCutLength(construction, ShakerPart::MID_STILE, w, h) * getMidStilecount();
-        total += dimensions.shakerparts.GetCutLength(construction, ShakerPart::MID_RAIL, w, h) * getMidRailcount();
-    }
-    total *= quantity;
-
-    return total;
-}
-
-
-double Door::GetBoneDetail_Total_Length() const
-{
-    if (construction == Construction::Slab)
-        return 0.0;
-    if (!hasBoneDetail())
-        return 0.0;
-    double total = 0.0;
-    total += dimensions.finishedWidth * 2.0;
-    total += dimensions.finishedHeight * 2.0;
-    total *= quantity;
-    return total;
-}
-
-bool Door::ValidatePanel(double& outWidth, double& outHeight) const
-{
-	const double minPanelSize = 1.0;
-	outWidth = dimensions.panel.GetPanelWidth(construction, dimensions.shakerparts, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight());
-	outHeight = dimensions.panel.GetPanelHeight(construction, dimensions.shakerparts, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight());
-	if (construction == Construction::Shaker || construction == Construction::SmallShaker)
-    {
-        if (outWidth < minPanelSize || outHeight < minPanelSize)
-            return false;
-    }
-    return true;
-}
-bool Door::ValidateShakerParts(std::string& error) const
-{
-    if (construction == Construction::Shaker)
-    {
-        for (size_t i = 0; i < static_cast<int>(ShakerPart::SHAKERPARTCOUNT); i++)
-        {
-            if (dimensions.shakerparts.width[i] <= 0.0)
-            {
-                std::string part = dimensions.shakerparts.GetPartString(static_cast<ShakerPart>(i));
-                if (static_cast<ShakerPart>(i) == ShakerPart::MID_RAIL && dimensions.shakerparts.mid_rail_count > 0)
-                {
-                    error += part + " Width undefined";
-                    return false;
-                }
-                else if (static_cast<ShakerPart>(i) == ShakerPart::MID_STILE && dimensions.shakerparts.mid_stile_count > 0)
-                {
-                    error += part + " Width undefined";
-                    return false;
-                }
-                else
-                {
-                    error += part + " Width undefined";
-                    return false;
-                }
-            }
-        }
-    }
-    if (construction == Construction::SmallShaker)
-    {
-        for (size_t i = 0; i < static_cast<int>(ShakerPart::SHAKERPARTCOUNT); i++)
-        {
-            if (dimensions.shakerparts.width[i] <= 0.0)
-            {
-                std::string part = dimensions.shakerparts.GetPartString(static_cast<ShakerPart>(i));
-                if (static_cast<ShakerPart>(i) == ShakerPart::MID_RAIL)
-                {
-                    continue;
-                }
-                else if (static_cast<ShakerPart>(i) == ShakerPart::MID_STILE)
-                {
-                    continue;
-                }
-                else
-                {
-                    error += part + " Width undefined";
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
-}
-
 void Door::Print() const
 {
     int denom = 32;
@@ -196,11 +110,10 @@ void Door::Print() const
     << "Panel Count: " << getPanelcount() << "\n" << std::endl;
 }
 
-void Door::AppendTigerStopCuts(std::vector<TigerStopItem>& cutlist) const
+void Door::AppendTigerStopCuts(std::pmr::vector<TigerStopItem>& cutlist, unsigned int copies) const
 {
-    const double w = dimensions.GetOversizedWidth();
-    const double h = dimensions.GetOversizedHeight();
     const auto& parts = dimensions.shakerparts;
+    const ConstructionStyle& style = Style();
 
     auto add = [&](ShakerPart part, unsigned int qty)
         {
@@ -208,134 +121,785 @@ void Door::AppendTigerStopCuts(std::vector<TigerStopItem>& cutlist) const
                 return;
 
             TigerStopItem c{};
-            if (getConstruction() == Construction::Shaker)
+            if (style.stock == StockGrouping::ByPart)
 			    c.group = GetStockGroup(part);
-            if (getConstruction() == Construction::SmallShaker)
+            else
                 c.group = StockGroup::Small_Shaker_Rail;
-			c.material = std::string(material);
-            c.length = parts.GetCutLength(construction, part, w, h);
+			c.material = materialId;
+            c.length = GetCutLength(part);
             c.quantity = qty;
             c.nominal_width = parts.width[static_cast<int>(part)];
             cutlist.push_back(c);
         };
 
-    if (getConstruction() == Construction::Shaker || getConstruction() == Construction::SmallShaker)
+    if (style.hasFrame)
     {
-        add(ShakerPart::TOP_RAIL, quantity);
-        add(ShakerPart::BOTTOM_RAIL, quantity);
-        add(ShakerPart::LEFT_STILE, quantity);
-        add(ShakerPart::RIGHT_STILE, quantity);
-        add(ShakerPart::MID_RAIL, quantity * parts.mid_rail_count);
-        add(ShakerPart::MID_STILE, quantity * parts.mid_stile_count);
+        add(ShakerPart::TOP_RAIL, copies);
+        add(ShakerPart::BOTTOM_RAIL, copies);
+        add(ShakerPart::LEFT_STILE, copies);
+        add(ShakerPart::RIGHT_STILE, copies);
+        add(ShakerPart::MID_RAIL, copies * parts.mid_rail_count);
+        add(ShakerPart::MID_STILE, copies * parts.mid_stile_count);
     }
 }
 
-void Door::AppendShakerLabel(std::vector<Shaker_CSV_Label>& label_list) const
+bool Door::GetShakerLabel(Shaker_CSV_Label& csv_label) const
 {
-    if (getConstruction() != Construction::Shaker)
-        return;
+    if (Style().labels != LabelList::Shaker)
+        return false;
     if (!hasPanel())
-        return;
-    Shaker_CSV_Label csv_label = {};
-    double doorwidth = dimensions.GetOversizedWidth();
-    double doorheight = dimensions.GetOversizedHeight();
-    double railCutLength = dimensions.shakerparts.GetCutLength(Construction::Shaker, ShakerPart::TOP_RAIL, doorwidth, doorheight);
-    double stileCutLength = dimensions.shakerparts.GetCutLength(Construction::Shaker, ShakerPart::LEFT_STILE, doorwidth, doorheight);
+        return false;
+    Length railCutLength = GetCutLength(ShakerPart::TOP_RAIL);
+    Length stileCutLength = GetCutLength(ShakerPart::LEFT_STILE);
     int denom = 32;
+    csv_label.finishedSize.clear();
+    FormatTo(std::back_inserter(csv_label.finishedSize), DoorText::FinishedSize, denom);
+    csv_label.railLength.assign("Rail: ");
+    Fraction::FormatDecimalTo(std::back_inserter(csv_label.railLength), railCutLength);
+    csv_label.stileLength.assign("Stile: ");
+    Fraction::FormatDecimalTo(std::back_inserter(csv_label.stileLength), stileCutLength);
+    return true;
+}
+
+bool Door::GetSlabLabel(Slab_CSV_Label& csv_label) const
+{
+    if (Style().labels == LabelList::Shaker)
+        return false;
+
+    int denom = 32;
+    csv_label.finishedSize.clear();
+    FormatTo(std::back_inserter(csv_label.finishedSize), DoorText::FinishedSize, denom);
+    return true;
+}
+
+template <typename Label>
+void Door::AppendLabelCopies(Label csv_label, std::pmr::vector<Label>& label_list) const
+{
     csv_label.cabNumber = label;
-    csv_label.finishedSize = getFinishedSizeLabel(denom);
-    csv_label.railLength = "Rail: " + Fraction::FormatDecimal(railCutLength);
-    csv_label.stileLength = "Stile: " + Fraction::FormatDecimal(stileCutLength);
-    csv_label.notes = notes;
+    char count[16];
+    const auto [countEnd, countEc] = std::to_chars(count, count + sizeof(count), quantity);
     for (unsigned int i = 0; i < quantity; ++i)
     {
-        std::string currentCount = std::to_string(i + 1);
-        std::string count = std::to_string(quantity);
-        std::string str_notes = notes;
-        if(str_notes.size() > 0)
-            csv_label.notes = currentCount + " of " + count + " " + str_notes;
-        else
-            csv_label.notes = currentCount + " of " + count;
+        // "<i> of <count>", then the notes if there are any
+        char current[16];
+        const auto [end, ec] = std::to_chars(current, current + sizeof(current), i + 1);
+        csv_label.notes.assign(current, end).append(" of ").append(count, countEnd);
+        if (hasNotes())
+            csv_label.notes.append(" ").append(notes);
         label_list.push_back(csv_label);
     }
 }
 
-void Door::AppendSlabLabel(std::vector<Slab_CSV_Label>& label_list) const
+// Everything SameBuild compares, hashed one by one so padding bytes never
+// count
+uint64_t Door::BuildHash() const
+{
+    uint64_t hash = Snapshot::HashSeed;
+    auto add = [&](const auto& value)
+        {
+            hash = Snapshot::HashBytes({ reinterpret_cast<const char*>(&value), sizeof(value) }, hash);
+        };
+    auto addText = [&](const DoorString& text)
+        {
+            hash = Snapshot::HashBytes(text.View(), hash);
+            add('\0');
+        };
+
+    addText(name);
+    addText(material);
+    addText(notes);
+    add(dimensions.finishedWidth);
+    add(dimensions.finishedHeight);
+    add(dimensions.oversizeWidth);
+    add(dimensions.oversizeHeight);
+    add(dimensions.bonedetail);
+    for (Length width : dimensions.shakerparts.width)
+        add(width);
+    add(dimensions.shakerparts.rabbet);
+    add(dimensions.shakerparts.stick_tolerance);
+    add(dimensions.shakerparts.cope_tolerance);
+    add(dimensions.shakerparts.mid_rail_count);
+    add(dimensions.shakerparts.mid_stile_count);
+    add(dimensions.panel.orientation);
+    add(dimensions.panel.hasPanel);
+    add(construction);
+    add(type);
+    return hash;
+}
+
+bool Door::SameBuild(const Door& other) const
+{
+    return name == other.name
+        && material == other.material
+        && notes == other.notes
+        && dimensions == other.dimensions
+        && construction == other.construction
+        && type == other.type;
+}
+
+void DoorGroups::Build(std::span<const Door> doors)
+{
+    m_groupOf.resize(doors.size());
+    std::vector<uint32_t> firsts;	// first door of each group
+    std::unordered_multimap<uint64_t, uint32_t> byHash;	// build hash to group
+    byHash.reserve(doors.size());
+
+    for (size_t i = 0; i < doors.size(); ++i)
+    {
+        const uint64_t hash = doors[i].BuildHash();
+        uint32_t group = static_cast<uint32_t>(firsts.size());
+
+        auto [begin, end] = byHash.equal_range(hash);
+        for (auto it = begin; it != end; ++it)
+        {
+            if (doors[firsts[it->second]].SameBuild(doors[i]))
+            {
+                group = it->second;
+                break;
+            }
+        }
+        if (group == firsts.size())
+        {
+            firsts.push_back(static_cast<uint32_t>(i));
+            byHash.emplace(hash, group);
+        }
+        m_groupOf[i] = group;
+    }
+
+    // Counting sort on the group keeps members in door order
+    m_start.assign(firsts.size() + 1, 0);
+    m_quantity.assign(firsts.size(), 0);
+    for (size_t i = 0; i < doors.size(); ++i)
+    {
+        ++m_start[m_groupOf[i] + 1];
+        m_quantity[m_groupOf[i]] += doors[i].getQuantity();
+    }
+    for (size_t g = 1; g < m_start.size(); ++g)
+        m_start[g] += m_start[g - 1];
+
+    std::vector<uint32_t> next(m_start.begin(), m_start.end() - 1);
+    m_members.resize(doors.size());
+    for (size_t i = 0; i < doors.size(); ++i)
+        m_members[next[m_groupOf[i]]++] = static_cast<uint32_t>(i);
+}
+
+void DoorStore::Build(std::span<const Door> doors, const DoorGroups& groups)
+{
+    const size_t n = groups.Size();
+    group.resize(n);
+    rowOf.resize(n);
+    vertical.resize(n);
+    hasPanel.resize(n);
+    oversizedWidth.resize(n);
+    oversizedHeight.resize(n);
+    finishedWidth.resize(n);
+    finishedHeight.resize(n);
+    boneDetail.resize(n);
+    for (auto& column : partWidth)
+        column.resize(n);
+    rabbet.resize(n);
+    stickTolerance.resize(n);
+    copeTolerance.resize(n);
+    midRailCount.resize(n);
+    midStileCount.resize(n);
+
+    // Counting sort on the style keeps each group in list order
+    const size_t styleCount = StyleRegistry::Global().Size();
+    groupStart.assign(styleCount + 1, 0);
+    for (size_t g = 0; g < n; ++g)
+        ++groupStart[static_cast<size_t>(doors[groups.First(g)].construction) + 1];
+    for (size_t c = 1; c <= styleCount; ++c)
+        groupStart[c] += groupStart[c - 1];
+
+    std::vector<size_t> next(groupStart.begin(), groupStart.end() - 1);
+
+    for (size_t g = 0; g < n; ++g)
+    {
+        const Door& d = doors[groups.First(g)];
+        const Dimensions& dims = d.dimensions;
+        const ShakerParts& parts = dims.shakerparts;
+        const size_t row = next[static_cast<size_t>(d.construction)]++;
+
+        group[row] = static_cast<uint32_t>(g);
+        rowOf[g] = static_cast<uint32_t>(row);
+        vertical[row] = dims.panel.orientation == Orientation::VERTICAL;
+        hasPanel[row] = dims.panel.hasPanel;
+        oversizedWidth[row] = dims.GetOversizedWidth();
+        oversizedHeight[row] = dims.GetOversizedHeight();
+        finishedWidth[row] = dims.finishedWidth;
+        finishedHeight[row] = dims.finishedHeight;
+        boneDetail[row] = dims.bonedetail;
+        for (size_t p = 0; p < PartCount; ++p)
+            partWidth[p][row] = parts.width[p];
+        rabbet[row] = parts.rabbet;
+        stickTolerance[row] = parts.stick_tolerance;
+        copeTolerance[row] = parts.cope_tolerance;
+        midRailCount[row] = parts.mid_rail_count;
+        midStileCount[row] = parts.mid_stile_count;
+    }
+}
+
+inline DoorFrame DoorStore::Frame(size_t row) const
 {
-    if (getConstruction() == Construction::Shaker)
+    DoorFrame f;
+    f.doorWidth = oversizedWidth[row];
+    f.doorHeight = oversizedHeight[row];
+    for (size_t p = 0; p < PartCount; ++p)
+        f.width[p] = partWidth[p][row];
+    f.rabbet = rabbet[row];
+    f.stick = stickTolerance[row];
+    f.cope = copeTolerance[row];
+    f.midRails = midRailCount[row];
+    f.midStiles = midStileCount[row];
+    return f;
+}
+
+void DoorStore::GeometryColumns::Resize(size_t rows)
+{
+    for (auto& column : length)
+        column.resize(rows);
+    for (auto& column : partWidth)
+        column.resize(rows);
+    for (auto* column : { &across, &along, &panelWidth, &panelHeight, &panelCutWidth, &panelCutHeight,
+        &panelRabbet, &railStileLength, &boneDetailLength })
+        column->resize(rows);
+    panelCount.resize(rows);
+}
+
+CutGeometry DoorStore::GeometryColumns::Row(size_t row) const
+{
+    CutGeometry g;
+    for (size_t p = 0; p < PartCount; ++p)
+    {
+        g.length[p] = length[p][row];
+        g.partWidth[p] = partWidth[p][row];
+    }
+    g.panelWidth = panelWidth[row];
+    g.panelHeight = panelHeight[row];
+    g.panelCutWidth = panelCutWidth[row];
+    g.panelCutHeight = panelCutHeight[row];
+    g.panelRabbet = panelRabbet[row];
+    g.panelCount = static_cast<unsigned int>(panelCount[row]);
+    g.railStileLength = railStileLength[row];
+    g.boneDetailLength = boneDetailLength[row];
+    return g;
+}
+
+void DoorStore::FinishRows(size_t begin, size_t end, GeometryColumns& out,
+    bool hasFrame, bool countsMidParts, bool rabbetedPanel) const
+{
+    // Panel cut sizes ignore the grain
+    for (size_t row = begin; row < end; ++row)
+    {
+        const int64_t across = out.across[row].Ticks(), along = out.along[row].Ticks();
+        out.panelWidth[row] = Length::FromTicks(vertical[row] != 0 ? across : along);
+    }
+    for (size_t row = begin; row < end; ++row)
+    {
+        const int64_t across = out.across[row].Ticks(), along = out.along[row].Ticks();
+        out.panelHeight[row] = Length::FromTicks(vertical[row] != 0 ? along : across);
+    }
+
+    for (size_t row = begin; row < end; ++row)
+        out.panelRabbet[row] = rabbet[row] - RABBET_ALLOWANCE;
+    const int64_t rabbets = rabbetedPanel ? 2 : 0;
+    for (size_t row = begin; row < end; ++row)
+        out.panelCutWidth[row] = out.across[row] + out.panelRabbet[row] * rabbets;
+    for (size_t row = begin; row < end; ++row)
+        out.panelCutHeight[row] = out.along[row] + out.panelRabbet[row] * rabbets;
+
+    if (!hasFrame)
+    {
+        std::fill(out.panelCount.begin() + begin, out.panelCount.begin() + end, 1);
+        std::fill(out.railStileLength.begin() + begin, out.railStileLength.begin() + end, Length());
+        std::fill(out.boneDetailLength.begin() + begin, out.boneDetailLength.begin() + end, Length());
         return;
+    }
 
-    Slab_CSV_Label csv_label = {};
-    double doorwidth = dimensions.GetOversizedWidth();
-    double doorheight = dimensions.GetOversizedHeight();
+    for (size_t row = begin; row < end; ++row)
+        out.panelCount[row] = hasPanel[row] != 0 ? (midRailCount[row] + 1) * (midStileCount[row] + 1) : 1;
 
-    int denom = 32;
-    csv_label.cabNumber = label;
-    csv_label.finishedSize = getFinishedSizeLabel(denom);
-    csv_label.notes = notes;
-    for (unsigned int i = 0; i < quantity; ++i)
+    const auto& length = out.length;
+    for (size_t row = begin; row < end; ++row)
+    {
+        out.railStileLength[row] = length[static_cast<size_t>(ShakerPart::TOP_RAIL)][row]
+            + length[static_cast<size_t>(ShakerPart::BOTTOM_RAIL)][row]
+            + length[static_cast<size_t>(ShakerPart::LEFT_STILE)][row]
+            + length[static_cast<size_t>(ShakerPart::RIGHT_STILE)][row];
+    }
+    if (countsMidParts)
+    {
+        for (size_t row = begin; row < end; ++row)
+        {
+            out.railStileLength[row] += length[static_cast<size_t>(ShakerPart::MID_STILE)][row] * midStileCount[row]
+                + length[static_cast<size_t>(ShakerPart::MID_RAIL)][row] * midRailCount[row];
+        }
+    }
+
+    for (size_t row = begin; row < end; ++row)
+    {
+        const int64_t perimeter = (finishedWidth[row] * 2 + finishedHeight[row] * 2).Ticks();
+        out.boneDetailLength[row] = Length::FromTicks(boneDetail[row] != Length() ? perimeter : 0);
+    }
+}
+
+// One part's columns under Rules. The part is a template argument so the
+// switch in CutLength and PartWidth folds away and each loop is straight-line.
+template <typename Rules, ShakerPart Part>
+void DoorStore::EvaluatePart(size_t begin, size_t end, GeometryColumns& out) const
+{
+    Length* length = out.length[static_cast<size_t>(Part)].data();
+    for (size_t row = begin; row < end; ++row)
+        length[row] = CutLength<Rules>(Frame(row), Part);
+    Length* width = out.partWidth[static_cast<size_t>(Part)].data();
+    for (size_t row = begin; row < end; ++row)
+        width[row] = PartWidth<Rules>(Frame(row), Part);
+}
+
+// Geometry of the rows of a code style, a column at a time
+template <typename Rules>
+void DoorStore::Evaluate(size_t begin, size_t end, GeometryColumns& out) const
+{
+    [&]<size_t... P>(std::index_sequence<P...>)
+    {
+        (EvaluatePart<Rules, static_cast<ShakerPart>(P)>(begin, end, out), ...);
+    }(std::make_index_sequence<PartCount>());
+    for (size_t row = begin; row < end; ++row)
+        out.across[row] = Rules::PanelWidth(Frame(row));
+    for (size_t row = begin; row < end; ++row)
+        out.along[row] = Rules::PanelHeight(Frame(row));
+
+    FinishRows(begin, end, out, Rules::hasFrame, Rules::countsMidParts, Rules::rabbetedPanel);
+}
+
+// The input column a formula length names; null for the allowance, which
+// is the same for every door
+const Length* DoorStore::TermColumn(StyleLength length) const
+{
+    switch (length)
+    {
+    case StyleLength::DoorWidth:	return oversizedWidth.data();
+    case StyleLength::DoorHeight:	return oversizedHeight.data();
+    case StyleLength::TopRail:		return partWidth[static_cast<size_t>(ShakerPart::TOP_RAIL)].data();
+    case StyleLength::BottomRail:	return partWidth[static_cast<size_t>(ShakerPart::BOTTOM_RAIL)].data();
+    case StyleLength::LeftStile:	return partWidth[static_cast<size_t>(ShakerPart::LEFT_STILE)].data();
+    case StyleLength::RightStile:	return partWidth[static_cast<size_t>(ShakerPart::RIGHT_STILE)].data();
+    case StyleLength::MidRail:		return partWidth[static_cast<size_t>(ShakerPart::MID_RAIL)].data();
+    case StyleLength::MidStile:		return partWidth[static_cast<size_t>(ShakerPart::MID_STILE)].data();
+    case StyleLength::Rabbet:		return rabbet.data();
+    case StyleLength::Stick:		return stickTolerance.data();
+    case StyleLength::Cope:			return copeTolerance.data();
+    default:						return nullptr;
+    }
+}
+
+// One formula over the rows, a pass per term it uses: the same sum as
+// StyleFormula::Evaluate, added up in another order, which integers allow
+void DoorStore::EvaluateFormula(const StyleFormula& formula, size_t begin, size_t end, Length* out) const
+{
+    std::fill(out + begin, out + end, formula.constant);
+
+    for (size_t l = 0; l < static_cast<size_t>(StyleLength::COUNT); ++l)
     {
-        std::string currentCount = std::to_string(i + 1);
-        std::string count = std::to_string(quantity);
-        std::string str_notes = notes;
-        if (str_notes.size() > 0)
-            csv_label.notes = currentCount + " of " + count + " " + str_notes;
+        const StyleLength length = static_cast<StyleLength>(l);
+        const Length* column = TermColumn(length);
+        const int64_t one = formula.coeff[StyleFormula::Term(length)];
+        const int64_t perMidRail = formula.coeff[StyleFormula::Term(length, StyleCount::MidRails)];
+        const int64_t perMidStile = formula.coeff[StyleFormula::Term(length, StyleCount::MidStiles)];
+        if (one == 0 && perMidRail == 0 && perMidStile == 0)
+            continue;
+
+        if (column == nullptr)
+        {
+            for (size_t row = begin; row < end; ++row)
+                out[row] += ALLOWANCE * (one + perMidRail * midRailCount[row] + perMidStile * midStileCount[row]);
+        }
         else
-            csv_label.notes = currentCount + " of " + count;
-        label_list.push_back(csv_label);
+        {
+            for (size_t row = begin; row < end; ++row)
+                out[row] += column[row] * (one + perMidRail * midRailCount[row] + perMidStile * midStileCount[row]);
+        }
+    }
+
+    if (formula.divisor == StyleDivisor::PanelsAcross)
+    {
+        for (size_t row = begin; row < end; ++row)
+            out[row] = out[row] / (midStileCount[row] + 1);
+    }
+    else if (formula.divisor == StyleDivisor::PanelsDown)
+    {
+        for (size_t row = begin; row < end; ++row)
+            out[row] = out[row] / (midRailCount[row] + 1);
+    }
+}
+
+// Geometry of the rows of a config style, a formula at a time
+void DoorStore::EvaluateTable(const ConstructionStyle& style, size_t begin, size_t end, GeometryColumns& out) const
+{
+    for (size_t p = 0; p < PartCount; ++p)
+    {
+        EvaluateFormula(style.length[p], begin, end, out.length[p].data());
+        EvaluateFormula(style.width[p], begin, end, out.partWidth[p].data());
+    }
+    // As CutLength: no length for mid parts the door does not have
+    Length* midRail = out.length[static_cast<size_t>(ShakerPart::MID_RAIL)].data();
+    for (size_t row = begin; row < end; ++row)
+        midRail[row] = midRailCount[row] == 0 ? Length() : midRail[row];
+    Length* midStile = out.length[static_cast<size_t>(ShakerPart::MID_STILE)].data();
+    for (size_t row = begin; row < end; ++row)
+        midStile[row] = midStileCount[row] == 0 ? Length() : midStile[row];
+
+    EvaluateFormula(style.panelWidth, begin, end, out.across.data());
+    EvaluateFormula(style.panelHeight, begin, end, out.along.data());
+
+    FinishRows(begin, end, out, style.hasFrame, style.countsMidParts, style.rabbetedPanel);
+}
+
+void DoorStore::ComputeGeometry(std::span<Door> doors, const DoorGroups& groups) const
+{
+    const StyleRegistry& styles = StyleRegistry::Global();
+    GeometryColumns columns;
+    columns.Resize(Size());
+
+    for (size_t c = 0; c + 1 < groupStart.size(); ++c)
+    {
+        const size_t begin = groupStart[c];
+        const size_t end = groupStart[c + 1];
+        if (begin == end)
+            continue;
+
+        const ConstructionStyle& style = styles[static_cast<Construction>(c)];
+        switch (style.kernel)
+        {
+        case StyleKernel::Slab:
+            Evaluate<SlabRules>(begin, end, columns);
+            break;
+        case StyleKernel::Shaker:
+            Evaluate<ShakerRules>(begin, end, columns);
+            break;
+        case StyleKernel::SmallShaker:
+            Evaluate<SmallShakerRules>(begin, end, columns);
+            break;
+        case StyleKernel::Table:
+            EvaluateTable(style, begin, end, columns);
+            break;
+        }
+    }
+
+    // Every door takes its group's row
+    for (size_t i = 0; i < doors.size(); ++i)
+    {
+        Door& d = doors[i];
+        d.geometry = columns.Row(rowOf[groups.GroupOf(i)]);
+        d.geometry.railStileLength = d.geometry.railStileLength * d.quantity;
+        d.geometry.boneDetailLength = d.geometry.boneDetailLength * d.quantity;
     }
 }
 
-void DoorList::ReadCsvTable(CsvTable doorsTable)
+// The table must have been read with CsvReader::Read(path, DoorColumns),
+// so that row[DoorColumn::...] addresses the right field.
+void DoorList::ReadCsvTable(const CsvTable& doorsTable)
 {
+    if (!doorsTable.HasSchema(DoorColumns))
+    {
+        m_log << "CSV table was not read with the door columns. No doors read.\n";
+        return;
+    }
+    if (!doorsTable.MissingColumns().empty())
+    {
+        ReportMissingColumns(doorsTable.MissingColumns());
+        return;
+    }
+
     std::vector<CsvError> errors;
+    std::vector<CsvError> warnings;
     unsigned int skippedCount = 0;
-    for (size_t i = 0; i < doorsTable.rows.size(); ++i)
+    for (size_t i = 0; i < doorsTable.RowCount(); ++i)
+        ReadRow(doorsTable.Row(i), i + 2, errors, warnings, skippedCount); // +2 for header row
+
+    FinishReading(errors, warnings, skippedCount);
+}
+
+// Builds doors straight from the parser, so no CsvTable is ever held in memory.
+void DoorList::ReadCsvFile(const std::string& csvPath)
+{
+    std::vector<CsvError> errors;
+    std::vector<CsvError> warnings;
+    std::vector<std::string_view> missing;
+    unsigned int skippedCount = 0;
+    const bool read = CsvReader::ForEachRow(csvPath, DoorColumns, missing, [&](const CsvRow& row, size_t i)
+        {
+            ReadRow(row, i + 2, errors, warnings, skippedCount); // +2 for header row
+        }, m_memory);
+
+    if (!missing.empty())
     {
-        Door d;
-        if (d.Create(doorsTable.rows[i], i + 2, errors)) // +2 for header row
-            m_doors.push_back(d);
-        else
-            skippedCount++;
+        ReportMissingColumns(missing);
+        return;
+    }
+    if (!read)
+    {
+        m_log << "Cannot open " << csvPath << ". No doors read.\n\n";
+        return;
+    }
+
+    FinishReading(errors, warnings, skippedCount);
+}
+
+// Reported once for the file instead of once per row.
+void DoorList::ReportMissingColumns(const std::vector<std::string_view>& missing) const
+{
+    m_log << "CSV is missing required column";
+    if (missing.size() > 1)
+        m_log << "s";
+    for (size_t i = 0; i < missing.size(); ++i)
+        m_log << (i == 0 ? ": " : ", ") << missing[i];
+    m_log << ". No doors read.\n\n";
+}
 
+void DoorList::ReadRow(const CsvRow& row, size_t row_index, std::vector<CsvError>& errors, std::vector<CsvError>& warnings, unsigned int& skippedCount)
+{
+    Door d;
+    // A skipped row's cut text is not worth a warning of its own
+    const size_t warningCount = warnings.size();
+    if (d.Create(row, row_index, errors, warnings))
+        m_doors.push_back(d);
+    else
+    {
+        warnings.resize(warningCount);
+        skippedCount++;
     }
-    std::cout << "Skipped " << skippedCount << " doors\n";
+}
+
+void DoorList::FinishReading(const std::vector<CsvError>& errors, const std::vector<CsvError>& warnings, unsigned int skippedCount)
+{
+    m_log << "Skipped " << skippedCount << " doors\n";
     for (const auto& e : errors)
     {
-        std::cout << "CSV Row " << e.row_index << " skipped: " << e.message << "\n";
+        m_log << "CSV Row " << e.row_index << " skipped: " << e.message << "\n";
+    }
+    for (const auto& w : warnings)
+    {
+        m_log << "CSV Row " << w.row_index << ": " << w.message << "\n";
+    }
+    m_log << "\n";
+    // Geometry for every build of door in one pass over the numeric columns
+    DoorGroups builds;
+    builds.Build(m_doors);
+    DoorStore store;
+    store.Build(m_doors, builds);
+    store.ComputeGeometry(m_doors, builds);
+
+    std::vector<uint8_t> removed;
+    m_diagnostics = ValidationRules::Global().Validate(m_doors, removed);
+    for (const DoorDiagnostic& diagnostic : m_diagnostics)
+    {
+        if (diagnostic.removed)
+            m_log << diagnostic.text << "\n";
+    }
+
+    // Warnings follow their doors to where they end up in the list
+    std::vector<uint32_t> position(m_doors.size());
+    size_t kept = 0;
+    for (size_t i = 0; i < m_doors.size(); ++i)
+    {
+        position[i] = static_cast<uint32_t>(kept);
+        if (!removed[i])
+            m_doors[kept++] = m_doors[i];
+    }
+    m_doors.resize(kept);
+    for (DoorDiagnostic& diagnostic : m_diagnostics)
+    {
+        if (!diagnostic.removed)
+            diagnostic.door = position[diagnostic.door];
+    }
+
+    m_log << "\nProcessed " << m_doors.size() << " valid door(s)\n";
+    makeUniqueLabels();
+    // Material IDs in door order, which LoadSnapshot relies on
+    for (auto& door : m_doors)
+        door.SetMaterialId(m_materials.Intern(door.MaterialView()));
+    m_view = m_doors;
+    m_groups.Build(m_view);
+}
+
+// Date stamped in the page header of the HTML reports
+static std::string ReportDate()
+{
+    auto now = std::chrono::system_clock::now();
+    std::tm tm = Platform::LocalTime(std::chrono::system_clock::to_time_t(now));
+
+    std::ostringstream date;
+    date << std::put_time(&tm, "%m-%d-%Y");
+    return date.str();
+}
+
+constexpr size_t PanelListCount = static_cast<size_t>(PanelList::None);
+
+// Cut list a door goes into
+static PanelList GetPanelList(const Door& door)
+{
+    const PanelList list = door.Style().panelList;
+    if (list == PanelList::Shaker && !door.hasPanel())
+        return PanelList::None;
+    return list;
+}
+
+static std::filesystem::path PanelCsvPath(const std::string& jobname, const std::string& material, PanelList list)
+{
+    const char* kind = nullptr;
+    switch (list)
+    {
+    case PanelList::Shaker: kind = " Shaker Panels.csv"; break;
+    case PanelList::SmallShaker: kind = " Small Shaker Panels.csv"; break;
+    case PanelList::Slab: kind = " Slab Doors.csv"; break;
+    default: return {};
     }
-    std::cout << "\n";
-    std::erase_if(m_doors, [] (const Door& door) {
-        double panelWidth = 0.0;
-        double panelHeight = 0.0;
+    return std::filesystem::path(material) / (jobname + " " + material + kind);
+}
 
-        bool isValid = door.ValidatePanel(panelWidth, panelHeight);
+// The parts of a report block that depend on the door's build alone, made
+// once per DoorGroups group
+struct DoorBuildHtml
+{
+    std::pmr::string tables;        // size table, and the part table of framed doors
+    std::pmr::string shape;         // the drawing up to its label
+    Html::Svg::DoorDiagram diagram; // for drawing each door's label
+};
+
+// Below this many blocks per thread the door report is drawn on fewer threads
+constexpr size_t MinReportBlocksPerThread = 64;
+
+// One thread's share of the door report: its blocks' html, the texts
+// reused from block to block and the build of the group it drew last. They
+// come from a pool that really frees, so whatever a run of blocks leaves
+// behind is reused by the next and the report needs no more memory for
+// ten thousand doors than for ten.
+struct ReportWorker
+{
+    std::pmr::unsynchronized_pool_resource memory;
+    std::pmr::string html{ &memory };
+    std::pmr::string header{ &memory };
+    std::pmr::string labels{ &memory };
+    std::pmr::string quantity{ &memory };
+    std::pmr::string groupLabels{ &memory };
+    std::optional<DoorBuildHtml> build;
+    size_t buildGroup = 0;
+};
+
+static DoorBuildHtml RenderDoorBuild(const Door& door, int denom, std::pmr::memory_resource* memory)
+{
+    DoorBuildHtml build{ .tables = std::pmr::string(memory), .shape = std::pmr::string(memory), .diagram = {} };
 
-        if (!isValid)
+    // Texts are written straight into the arena
+    auto text = [&](DoorText which)
         {
-            std::cout << "Warning: Removed Door "
-                << door.getNameString() << " " << door.getLabelString()
-                << " Below minimum panel size. "
-                << panelWidth << " x " << panelHeight << "\n";
-        }
-        else
+            std::pmr::string s(memory);
+            door.FormatTo(std::back_inserter(s), which, denom);
+            return s;
+        };
+    auto lines = [&](DoorText first, DoorText second)
         {
-            std::string errormsg = "";
-            isValid = door.ValidateShakerParts(errormsg);
+            std::pmr::string s = text(first);
+            s += '\n';
+            door.FormatTo(std::back_inserter(s), second, denom);
+            return s;
+        };
 
-            if (!isValid)
-            {
-                std::cout << "Warning: Removed Door "
-                    << door.getNameString() << " " << door.getLabelString()
-                    << " " << errormsg << "\n";
-            }
-        }
+    const std::pmr::string finishedwidth = text(DoorText::FinishedWidth);
+    const std::pmr::string cutwidth = lines(DoorText::CutWidth, DoorText::OversizeWidth);
+	const std::pmr::string finishedheight = text(DoorText::FinishedHeight);
+	const std::pmr::string cutheight = lines(DoorText::CutHeight, DoorText::OversizeHeight);
+	const std::pmr::string panelwidth = text(DoorText::PanelWidth);
+	const std::pmr::string panelheight = text(DoorText::PanelHeight);
+    Html::HtmlTable maintable(memory);
 
-        return !isValid;
-        });
+    if (door.hasPanel())
+    {
+        maintable.AddColumn({ "", "33%" });
+        maintable.AddColumn({ "", "33%" });
+        maintable.AddColumn({ "", "33%" });
 
-    std::cout << "\nProcessed " << m_doors.size() << " valid door(s)\n";
-    makeUniqueLabels();
+        maintable.AddRow({ finishedwidth, cutwidth, panelwidth });
+	    maintable.AddRow({ finishedheight, cutheight, panelheight });
+    }
+    else
+    {
+        maintable.AddColumn({ "", "50%" });
+        maintable.AddColumn({ "", "50%" });
+
+        maintable.AddRow({ finishedwidth, cutwidth });
+        maintable.AddRow({ finishedheight, cutheight });
+    }
+
+    Html::HtmlTable shakerTable(memory);
+	shakerTable.AddColumn(text(DoorText::LeftStileWidth), "16.6%");
+    shakerTable.AddColumn(text(DoorText::RightStileWidth), "16.6%");
+    shakerTable.AddColumn(text(DoorText::TopRailWidth), "16.6%");
+    shakerTable.AddColumn(text(DoorText::BottomRailWidth), "16.6%");
+	if (door.hasMidRail())
+        shakerTable.AddColumn(text(DoorText::MidRailWidth), "16.6%");
+	if (door.hasMidStile())
+        shakerTable.AddColumn(text(DoorText::MidStileWidth), "16.6%");
+
+    if (door.hasMidRail() && door.hasMidStile())
+    {
+        shakerTable.AddRow({ text(DoorText::LeftStileLength),
+            text(DoorText::RightStileLength),
+            text(DoorText::TopRailLength),
+            text(DoorText::BottomRailLength),
+            text(DoorText::MidRailLength),
+            text(DoorText::MidStileLength) });
+    }
+    else if (door.hasMidRail() && !door.hasMidStile())
+    {
+        shakerTable.AddRow({ text(DoorText::LeftStileLength),
+            text(DoorText::RightStileLength),
+            text(DoorText::TopRailLength),
+            text(DoorText::BottomRailLength),
+            text(DoorText::MidRailLength) });
+    }
+    else if (!door.hasMidRail() && door.hasMidStile())
+    {
+        shakerTable.AddRow({ text(DoorText::LeftStileLength),
+            text(DoorText::RightStileLength),
+            text(DoorText::TopRailLength),
+            text(DoorText::BottomRailLength),
+            text(DoorText::MidStileLength) });
+    }
+    else
+    {
+        shakerTable.AddRow({ text(DoorText::LeftStileLength),
+            text(DoorText::RightStileLength),
+            text(DoorText::TopRailLength),
+            text(DoorText::BottomRailLength) });
+    }
+
+    maintable.AppendHtml(build.tables);
+    if (door.Style().hasFrame)
+        shakerTable.AppendHtml(build.tables);
+
+    Html::Svg::DoorDiagram& diagram = build.diagram;
+
+	const Html::Svg::DoorStyle style = door.Style().drawing;
+    double railadjustment = door.getOversizeHeight() / 2.0;
+    double stileadjustment = door.getOversizeWidth() / 2.0;
+
+    diagram
+        .SetSize(50, 50)             // CSS size
+        .SetViewBox(0, 0, door.getFinishedWidth(), door.getFinishedHeight())     // logical drawing space
+        .SetDoorStyle(style)
+        .SetLeftStileWidth(door.GetShakerPartWidth(ShakerPart::LEFT_STILE) - stileadjustment)
+        .SetRightStileWidth(door.GetShakerPartWidth(ShakerPart::RIGHT_STILE) - stileadjustment)
+        .SetTopRailWidth(door.GetShakerPartWidth(ShakerPart::TOP_RAIL) - railadjustment)
+        .SetBottomRailWidth(door.GetShakerPartWidth(ShakerPart::BOTTOM_RAIL) - railadjustment)
+        .SetMidWidth(door.GetShakerPartWidth(ShakerPart::MID_RAIL))
+        .SetMidRail(door.getMidRailcount())
+		.SetMidStile(door.getMidStilecount())
+        .SetBoneDetail(door.GetBoneDetail())
+        .SetStrokeWidth(0.1);
+    diagram.AppendShape(build.shape);
+    return build;
 }
 
 void DoorList::WriteHTMLReport(const char* jobname) const
@@ -343,7 +907,10 @@ void DoorList::WriteHTMLReport(const char* jobname) const
     constexpr int denom = 32;
 	std::string title = std::string(jobname) + " Door Report";
     std::string file = std::string(jobname) + " Door Report.html";
-    Html::HtmlDocument doc(title);
+    if (!ShouldWrite(file))
+        return;
+
+    Html::HtmlDocument doc(title, m_memory);
 
 
     doc.AddStyle(R"(
@@ -478,6 +1045,9 @@ tfoot { display: table-footer-group; }
 
 )");
 
+    // The blocks go to the file as they are made rather than all being held
+    if (!doc.BeginFile(OutputPath(file).string()))
+        return;
 
     doc.AddRawHtml(R"(
 <table class="page-table">
@@ -495,132 +1065,153 @@ tfoot { display: table-footer-group; }
 
     doc.BeginGrid("door-grid");
 
-    for (const auto& door : m_doors)
+    // Blocks are drawn by up to m_reportThreads workers, each into its own
+    // buffer, in runs of BlocksPerThreadRun blocks per worker. When every
+    // worker has finished a run the buffers go to the file in door order, so
+    // the report does not depend on the thread count, and no more than one
+    // run of blocks and one build per worker is ever held.
+    constexpr size_t BlocksPerThreadRun = 8;
+    const size_t blockCount = m_consolidated ? m_groups.Size() : m_view.size();
+    unsigned int threads = m_reportThreads != 0 ? m_reportThreads : std::thread::hardware_concurrency();
+    threads = static_cast<unsigned int>(std::clamp<size_t>(blockCount / MinReportBlocksPerThread, 1, std::max(threads, 1u)));
+    std::vector<ReportWorker> workers(threads);
+
+    // A group's build is drawn again when its doors are not together, rather
+    // than every build being kept for the whole report
+    auto buildOf = [&](ReportWorker& worker, size_t g) -> const DoorBuildHtml&
     {
-        doc.AddRawHtml("<div class='door-block'>");
-        doc.AddRawHtml("<div class='door-row'>");
-        doc.AddRawHtml("<div class='door-data'>");
-
-
-        unsigned int quantity = door.getQuantity();
-        std::string spacer = "  |  ";
-
-        std::string header = std::string(door.getConstructionString()) + " " + std::string(door.getTypeString()) + " " + door.getNameString() + spacer + door.getLabelString() + spacer + door.getGrainOrientationString() + 
-            "\n" + door.getMaterialString() + spacer + door.getQuantityString();
-        if (door.hasBoneDetail())
-            header += spacer + door.getBoneDetailString(denom);
-        if (door.hasNotes())
-			header += spacer + std::string(door.getNotes());
-        doc.AddHeading(header, 3);
-
-
-        std::string finishedwidth = door.getFinishedWidthString(denom);
-        std::string cutwidth = door.getCutWidthString(denom) + "\n" + door.getOversizeWidthString(denom);
-		std::string finishedheight = door.getFinishedHeightString(denom);
-		std::string cutheight = door.getCutHeightString(denom) + "\n" + door.getOversizeHeightString(denom);
-		std::string panelwidth = door.getPanelWidthString(denom);
-		std::string panelheight = door.getPanelHeightString(denom);
-        Html::HtmlTable maintable;
-
-        if (door.hasPanel())
+        if (!worker.build || worker.buildGroup != g)
         {
-            maintable.AddColumn({ "", "33%" });
-            maintable.AddColumn({ "", "33%" });
-            maintable.AddColumn({ "", "33%" });
-
-            maintable.AddRow({ finishedwidth, cutwidth, panelwidth });
-		    maintable.AddRow({ finishedheight, cutheight, panelheight });
+            worker.build.reset();
+            worker.build.emplace(RenderDoorBuild(m_view[m_groups.First(g)], denom, &worker.memory));
+            worker.buildGroup = g;
         }
-        else
-        {
-            maintable.AddColumn({ "", "50%" });
-            maintable.AddColumn({ "", "50%" });
+        return *worker.build;
+    };
 
-            maintable.AddRow({ finishedwidth, cutwidth });
-            maintable.AddRow({ finishedheight, cutheight });
-        }
-
-        Html::HtmlTable shakerTable;
-		shakerTable.AddColumn({ door.getLeftStileWidthString(denom), "16.6%" });
-        shakerTable.AddColumn({ door.getRightStileWidthString(denom), "16.6%" });
-        shakerTable.AddColumn({ door.getTopRailWidthString(denom), "16.6%" });
-        shakerTable.AddColumn({ door.getBottomRailWidthString(denom), "16.6%" });
-		if (door.hasMidRail())
-            shakerTable.AddColumn({ door.getMidRailWidthString(denom), "16.6%" });
-		if (door.hasMidStile())
-            shakerTable.AddColumn({ door.getMidStileWidthString(denom), "16.6%" });
-
-        if (door.hasMidRail() && door.hasMidStile())
+    auto addBlock = [&](ReportWorker& worker, const Door& door, const DoorBuildHtml& build, std::string_view labels, std::string_view quantity, std::string_view svgLabel)
+    {
+        std::pmr::string& html = worker.html;
+        std::pmr::string& header = worker.header;
+        html += "<div class='door-block'>\n";
+        html += "<div class='door-row'>\n";
+        html += "<div class='door-data'>\n";
+
+        constexpr std::string_view spacer = "  |  ";
+        auto add = [&](DoorText text) { door.FormatTo(std::back_inserter(header), text, denom); };
+
+        header.clear();
+        add(DoorText::Construction);
+        header.append(" ");
+        add(DoorText::Type);
+        header.append(" ");
+        add(DoorText::Name);
+        header.append(spacer).append(labels).append(spacer);
+        add(DoorText::GrainOrientation);
+        header.append("\n");
+        add(DoorText::Material);
+        header.append(spacer).append(quantity);
+        if (door.hasBoneDetail())
         {
-            shakerTable.AddRow({ door.getLeftStileLengthString(denom),
-                door.getRightStileLengthString(denom),
-                door.getTopRailLengthString(denom),
-                door.getBottomRailLengthString(denom),
-                door.getMidRailLengthString(denom),
-                door.getMidStileLengthString(denom) });
+            header.append(spacer);
+            add(DoorText::BoneDetail);
         }
-        else if (door.hasMidRail() && !door.hasMidStile())
+        if (door.hasNotes())
         {
-            shakerTable.AddRow({ door.getLeftStileLengthString(denom),
-                door.getRightStileLengthString(denom),
-                door.getTopRailLengthString(denom),
-                door.getBottomRailLengthString(denom),
-                door.getMidRailLengthString(denom) });
+            header.append(spacer);
+            add(DoorText::SpecialNotes);
         }
-        else if (!door.hasMidRail() && door.hasMidStile())
+        html += "<h3>";
+        Html::Util::AppendEscaped(html, header);
+        html += "</h3>\n";
+
+        html += build.tables;
+        html += "</div>\n";
+
+        html += "<div class='door-drawing'>\n";
+        html += build.shape;
+        build.diagram.AppendLabel(html, svgLabel);
+        html += "\n";
+        html += "</div>\n";
+        html += "</div>\n";
+        html += "</div>\n";
+    };
+
+    auto addDoorBlock = [&](ReportWorker& worker, const Door& door, const DoorBuildHtml& build)
+    {
+        worker.labels.clear();
+        door.FormatTo(std::back_inserter(worker.labels), DoorText::Label);
+        worker.quantity.clear();
+        door.FormatTo(std::back_inserter(worker.quantity), DoorText::Quantity);
+        addBlock(worker, door, build, worker.labels, worker.quantity, door.LabelView());
+    };
+
+    // One block per group when consolidated, listing every member's label
+    auto addGroupBlock = [&](ReportWorker& worker, size_t g)
+    {
+        const Door& first = m_view[m_groups.First(g)];
+        const auto members = m_groups.Members(g);
+        if (members.size() == 1)
         {
-            shakerTable.AddRow({ door.getLeftStileLengthString(denom),
-                door.getRightStileLengthString(denom),
-                door.getTopRailLengthString(denom),
-                door.getBottomRailLengthString(denom),
-                door.getMidStileLengthString(denom) });
+            addDoorBlock(worker, first, buildOf(worker, g));
+            return;
         }
-        else
+
+        std::pmr::string& groupLabels = worker.groupLabels;
+        groupLabels.clear();
+        for (uint32_t member : members)
         {
-            shakerTable.AddRow({ door.getLeftStileLengthString(denom),
-                door.getRightStileLengthString(denom),
-                door.getTopRailLengthString(denom),
-                door.getBottomRailLengthString(denom) });
+            if (!groupLabels.empty())
+                groupLabels += ", ";
+            groupLabels += m_view[member].LabelView();
         }
-        
-        doc.AddTable(maintable);
-        if (door.getConstruction() == Construction::Shaker || door.getConstruction() == Construction::SmallShaker)
+        worker.labels.assign("(Labels: ").append(groupLabels).append(")");
+
+        char digits[16];
+        const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), m_groups.Quantity(g));
+        worker.quantity.assign("Quantity: ").append(digits, end);
+        addBlock(worker, first, buildOf(worker, g), worker.labels, worker.quantity, groupLabels);
+    };
+
+    // Written by the barrier once all workers have arrived, and so read by
+    // them only between runs
+    size_t run = 0;
+    std::barrier runDone(threads, [&]() noexcept
+        {
+            for (ReportWorker& worker : workers)
+            {
+                doc.AddRenderedHtml(worker.html);
+                worker.html.clear();
+            }
+            run += BlocksPerThreadRun * threads;
+        });
+
+    auto drawBlocks = [&](size_t w)
+    {
+        ReportWorker& worker = workers[w];
+        while (run < blockCount)
         {
-		    doc.AddTable(shakerTable);
+            const size_t first = std::min(blockCount, run + w * BlocksPerThreadRun);
+            const size_t last = std::min(blockCount, first + BlocksPerThreadRun);
+            for (size_t i = first; i < last; ++i)
+            {
+                if (m_consolidated)
+                    addGroupBlock(worker, i);
+                else
+                    addDoorBlock(worker, m_view[i], buildOf(worker, m_groups.GroupOf(i)));
+            }
+            runDone.arrive_and_wait();
         }
-        doc.AddRawHtml("</div>");
-
-        doc.AddRawHtml("<div class='door-drawing'>");
-        Html::Svg::DoorDiagram diagram;
-
-		Html::Svg::DoorStyle style = Html::Svg::DoorStyle::Slab;
-		if (door.getConstruction() == Construction::Shaker)
-			style = Html::Svg::DoorStyle::Shaker;
-		if (door.getConstruction() == Construction::SmallShaker)
-			style = Html::Svg::DoorStyle::ShakerMitered;
-        double railadjustment = door.getOversizeHeight() / 2.0;
-        double stileadjustment = door.getOversizeWidth() / 2.0;
-
-        diagram
-            .SetSize(50, 50)             // CSS size
-            .SetViewBox(0, 0, door.getFinishedWidth(), door.getFinishedHeight())     // logical drawing space
-            .SetDoorStyle(style)
-            .SetLeftStileWidth(door.GetShakerPartWidth(ShakerPart::LEFT_STILE) - stileadjustment)
-            .SetRightStileWidth(door.GetShakerPartWidth(ShakerPart::RIGHT_STILE) - stileadjustment)
-            .SetTopRailWidth(door.GetShakerPartWidth(ShakerPart::TOP_RAIL) - railadjustment)
-            .SetBottomRailWidth(door.GetShakerPartWidth(ShakerPart::BOTTOM_RAIL) - railadjustment)
-            .SetMidWidth(door.GetShakerPartWidth(ShakerPart::MID_RAIL))
-            .SetMidRail(door.getMidRailcount())
-			.SetMidStile(door.getMidStilecount())
-            .SetBoneDetail(door.GetBoneDetail())
-            .SetStrokeWidth(0.1)
-            .SetLabel(door.getsvgLabel());
-
-        doc.AddRawHtml(diagram.ToHtml()); // or Slab / Mitered
-        doc.AddRawHtml("</div>");
-        doc.AddRawHtml("</div>");
-        doc.AddRawHtml("</div>");
-    }
+    };
+
+    // This thread is the first worker
+    std::vector<std::thread> helpers;
+    helpers.reserve(threads - 1);
+    for (unsigned int w = 1; w < threads; ++w)
+        helpers.emplace_back(drawBlocks, w);
+    drawBlocks(0);
+    for (auto& helper : helpers)
+        helper.join();
 
     
     doc.EndGrid();
@@ -631,123 +1222,74 @@ tfoot { display: table-footer-group; }
 </table>
 )");
 
-    auto now = std::chrono::system_clock::now();
-    std::time_t t = std::chrono::system_clock::to_time_t(now);
-
-    std::tm tm{};
-    localtime_s(&tm, &t);   // <-- safe MSVC version
-
     std::ostringstream hdr;
     hdr << "<div class='page-header'>Job: "
         << jobname
         << " &nbsp;&nbsp; | &nbsp;&nbsp; Date: "
-        << std::put_time(&tm, "%m-%d-%Y")
+        << ReportDate()
         << "</div>";
 
     doc.AddRawHtml(hdr.str());
-
-
-    doc.WriteToFile(file);
+    doc.Finish();
 }
 
 void DoorList::WritePanelCsvs(const std::string& jobname) const
 {
-    using CsvBuffers = std::map<std::filesystem::path, std::ostringstream>;
-    CsvBuffers buffers;
+    // Rows are routed by material ID and list; a file's path is only made
+    // when it is written
+    std::vector<std::array<std::ostringstream, PanelListCount>> buffers(m_materials.Size());
 
-    if (containsShaker())
+    for (const auto& door : m_view)
     {
-        for (const auto& door : m_doors)
-        {
-            if (door.getConstruction() != Construction::Shaker)
-                continue;
-            if (!door.hasPanel())
-                continue;
-            const std::string material = door.GetPanelMaterial();
-            std::filesystem::path dir(material);
-            std::filesystem::create_directories(dir);
-
-            std::ostringstream filename;
-            filename << jobname << " " << material << " Shaker Panels.csv";
+        const PanelList list = GetPanelList(door);
+        if (list == PanelList::None)
+            continue;
 
-            std::filesystem::path filePath = dir / filename.str();
-            std::ostringstream& buf = buffers[filePath];
-            if (buf.tellp() == 0)
-            {
+        std::ostringstream& buf = buffers[door.GetMaterialId()][static_cast<size_t>(list)];
+        if (buf.tellp() == 0)
+        {
+            if (list == PanelList::Shaker)
                 buf << "Name,Label,Qty,Width,Height,Rabbet\n";
-            }
-            buf << door.getPanelName() << ","
-                << door.getPanelLabel() << ","
-                << door.getPanelQuantity() << ","
-                << FormatTrimmed(door.GetPanelWidth()) << ","
-                << FormatTrimmed(door.GetPanelHeight()) << ","
-                << FormatTrimmed(door.GetPanelRabbet()) << "\n";
+            else
+                buf << "Name,Label,Qty,Width,Height\n";
         }
-    }
-    if (containsSmallShaker())
-    {
-        for (const auto& door : m_doors)
+        const std::ostreambuf_iterator<char> out(buf);
+        door.FormatTo(out, DoorText::Name);
+        buf << ",";
+        door.FormatTo(out, DoorText::PanelLabel);
+        buf << "," << door.getPanelQuantity() << ",";
+        Fraction::FormatDecimalTo(out, door.GetPanelWidth());
+        buf << ",";
+        Fraction::FormatDecimalTo(out, door.GetPanelHeight());
+        if (list == PanelList::Shaker)
         {
-            if (door.getConstruction() != Construction::SmallShaker)
-                continue;
-
-            const std::string material = door.GetPanelMaterial();
-            std::filesystem::path dir(material);
-            std::filesystem::create_directories(dir);
-
-            std::ostringstream filename;
-            filename << jobname << " " << material << " Small Shaker Panels.csv";
-
-            std::filesystem::path filePath = dir / filename.str();
-            std::ostringstream& buf = buffers[filePath];
-            if (buf.tellp() == 0)
-            {
-                buf << "Name,Label,Qty,Width,Height\n";
-            }
-            buf << door.getPanelName() << ","
-                << door.getPanelLabel() << ","
-                << door.getPanelQuantity() << ","
-                << FormatTrimmed(door.GetPanelWidth()) << ","
-                << FormatTrimmed(door.GetPanelHeight()) << "\n";
+            buf << ",";
+            Fraction::FormatDecimalTo(out, door.GetPanelRabbet());
         }
+        buf << "\n";
     }
-    if (containsSlab())
+
+    for (uint32_t material = 0; material < buffers.size(); ++material)
     {
-        for (const auto& door : m_doors)
+        for (size_t list = 0; list < PanelListCount; ++list)
         {
-            if (door.getConstruction() != Construction::Slab)
+            std::ostringstream& buffer = buffers[material][list];
+            if (buffer.tellp() == 0)
                 continue;
 
-            const std::string material = door.GetPanelMaterial();
-            std::filesystem::path dir(material);
-            std::filesystem::create_directories(dir);
-
-            std::ostringstream filename;
-            filename << jobname << " " << material << " Slab Doors.csv";
-
-            std::filesystem::path filePath = dir / filename.str();
-            std::ostringstream& buf = buffers[filePath];
-            if (buf.tellp() == 0)
-            {
-                buf << "Name,Label,Qty,Width,Height\n";
-            }
-            buf << door.getPanelName() << ","
-                << door.getPanelLabel() << ","
-                << door.getPanelQuantity() << ","
-                << FormatTrimmed(door.GetPanelWidth()) << ","
-				<< FormatTrimmed(door.GetPanelHeight()) << "\n";
-		}
-    }
-    for (const auto& [filepath, buffer] : buffers)
-    {
-        std::ofstream out(filepath);
-        out << buffer.str();
+            const std::filesystem::path filepath = PanelCsvPath(jobname, m_materials[material], static_cast<PanelList>(list));
+            std::filesystem::create_directories(OutputPath(filepath.parent_path()));
+            if (!ShouldWrite(filepath))
+                continue;
+            std::ofstream out(OutputPath(filepath));
+            out << buffer.str();
+        }
     }
 }
 
 
 // helper to turn group enum into text
-static std::string GroupToString(StockGroup g)
+static std::string_view GroupToString(StockGroup g)
 {
     switch (g)
     {
@@ -758,16 +1300,27 @@ static std::string GroupToString(StockGroup g)
     return "UNKNOWN";
 }
 
-static void WriteGroupedCSVs(const std::vector<TigerStopItem>& items, const std::string& jobname)
+static std::filesystem::path TigerStopCsvPath(const std::string& jobname, const std::string& material, StockGroup group, Length width)
 {
-    using LengthMap = std::map<double, unsigned int, std::greater<double>>;
-    using Material = std::string;
-    // Material ? Group ? Width ? Lengths
-    using WidthMap = std::map<double, LengthMap>;
-    using GroupMap = std::map<StockGroup, WidthMap>;
-    using MaterialMap = std::map<Material, GroupMap>;
-
-    MaterialMap grouped;
+    std::ostringstream filename;
+    filename << jobname << " "
+        << material << " "
+        << GroupToString(group) << " "
+        << FormatTrimmed(width)
+        << ".csv";
+    return std::filesystem::path("Tiger Stop") / filename.str();
+}
+
+static void WriteGroupedCSVs(std::span<const TigerStopItem> items, const StringTable& materials, const std::string& jobname,
+    const std::filesystem::path& root, std::pmr::memory_resource* memory, const std::function<bool(const std::filesystem::path&)>& shouldWrite)
+{
+    // Lengths are exact, so equal cuts always share a row
+    using LengthMap = std::pmr::map<Length, unsigned int, std::greater<Length>>;
+    // Material ID ? Group ? Width ? Lengths
+    using WidthMap = std::pmr::map<Length, LengthMap>;
+    using GroupMap = std::pmr::map<StockGroup, WidthMap>;
+
+    std::pmr::vector<GroupMap> grouped(materials.Size(), memory);
     // ---------- Grouping ----------
     for (const auto& it : items)
     {
@@ -777,12 +1330,12 @@ static void WriteGroupedCSVs(const std::vector<TigerStopItem>& items, const std:
             [it.length] += it.quantity;
     }
 
-    std::filesystem::path dir("Tiger Stop");
-    std::filesystem::create_directories(dir);
+    std::filesystem::create_directories(root / "Tiger Stop");
 
     std::string title = std::string(jobname) + " TigerStop Report";
     std::string file = std::string(jobname) + " TigerStop Report.html";
-    Html::HtmlDocument doc(title);
+    const bool writeReport = shouldWrite(file);
+    Html::HtmlDocument doc(title, memory);
 
     doc.AddStyle(R"(
 
@@ -837,17 +1390,15 @@ td {
 
 )");
 
-    auto now = std::chrono::system_clock::now();
-    std::time_t t = std::chrono::system_clock::to_time_t(now);
-
-    std::tm tm {};
-    localtime_s(&tm, &t);   // <-- safe MSVC version
+    // Streamed as the tables are made
+    if (writeReport)
+        doc.BeginFile((root / file).string());
 
     std::ostringstream hdr;
     hdr << "<div class='page-header'>Job: "
         << jobname
         << " &nbsp;&nbsp; | &nbsp;&nbsp; Date: "
-        << std::put_time(&tm, "%m-%d-%Y")
+        << ReportDate()
         << "</div>";
 
     doc.AddRawHtml(hdr.str());
@@ -855,44 +1406,57 @@ td {
 
 
     // ---------- Writing ----------
-    for (auto& [material, groups] : grouped)
+    // Materials in name order, as the report has always listed them
+    for (uint32_t id : materials.SortedIds())
     {
-        for (auto& [group, widths] : groups)
+        const std::string& material = materials[id];
+        for (auto& [group, widths] : grouped[id])
         {
             for (auto& [width, lengths] : widths)
             {
-                std::ostringstream filename;
-                filename << jobname << " "
-                    << material << " "
-                    << GroupToString(group) << " "
-                    << FormatTrimmed(width)
-                    << ".csv";
- 
-
-
-                std::ofstream out(dir / filename.str());
-                if (!out)
+                // An up-to-date CSV still feeds the report's table
+                const std::filesystem::path csvPath = TigerStopCsvPath(jobname, material, group, width);
+                std::ofstream out;
+                if (shouldWrite(csvPath))
+                {
+                    out.open(root / csvPath);
+                    if (!out)
+                        continue;
+                    out << "length,quantity\n";
+                }
+                else if (!writeReport)
                     continue;
 
-                out << "length,quantity\n";
-                Html::HtmlTable maintable;
+                Html::HtmlTable maintable(memory);
                 maintable.AddColumn({ "Material", "16%" });
                 maintable.AddColumn({ "Type", "16%" });
                 maintable.AddColumn({ "Width", "22%" });
                 maintable.AddColumn({ "Length", "36%" });
                 maintable.AddColumn({ "Quantity", "10%" });
 
+                // Cell texts, reused for every row
+                std::pmr::string widthText(memory);
+                Fraction(width, 32).StringTo(std::back_inserter(widthText));
+                std::pmr::string lengthText(memory);
+
                 for (auto& [length, qty] : lengths)
                 {
-					Fraction lengthfrac(length, 32);
-					Fraction widthfrac(width, 32);
-                    maintable.AddRow({ material, GroupToString(group), widthfrac.GetString(), lengthfrac.GetString(), FormatTrimmed(qty)});
-                    out << FormatTrimmed(length) << ","
-                        << qty << "\n";
+                    lengthText.clear();
+                    Fraction(length, 32).StringTo(std::back_inserter(lengthText));
+                    char count[16];
+                    const auto [end, ec] = std::to_chars(count, count + sizeof(count), qty);
+                    if (writeReport)
+                        maintable.AddRow({ material, GroupToString(group), widthText, lengthText, std::string_view(count, end - count) });
+                    if (out.is_open())
+                    {
+                        Fraction::FormatDecimalTo(std::ostreambuf_iterator<char>(out), length);
+                        out << "," << qty << "\n";
+                    }
                 }
                 //maintable.AddRow({ " ", " ", " ", " ", " "});
                 //maintable.AddRow({ " ", " ", " ", " ", " " });
-	            doc.AddTable(maintable);
+                if (writeReport)
+                    doc.AddTable(maintable);
             }
         }
     }
@@ -903,34 +1467,55 @@ td {
 )");
 
 
+    if (writeReport)
+        doc.Finish();
+}
 
-
-    doc.WriteToFile(file);
+// Door::AppendTigerStopCuts for every door; the cuts of a group of
+// identical doors are worked out once, for all their copies
+std::pmr::vector<TigerStopItem> DoorList::TigerStopCutList() const
+{
+    std::pmr::vector<TigerStopItem> cutlist(m_memory);
+    for (size_t g = 0; g < m_groups.Size(); ++g)
+        m_view[m_groups.First(g)].AppendTigerStopCuts(cutlist, m_groups.Quantity(g));
+    return cutlist;
 }
 
 void DoorList::WriteTigerStopCsvs(const std::string& jobname) const
 {
-    std::vector<TigerStopItem> cutlist;
+    const std::pmr::vector<TigerStopItem> cutlist = TigerStopCutList();
+    WriteGroupedCSVs(cutlist, m_materials, jobname, m_outputRoot, m_memory, [this](const std::filesystem::path& output) { return ShouldWrite(output); });
+}
+
+// The labels of every door, in door order; the label a group shares is
+// made once and copied for each member
+template <typename Label>
+std::pmr::vector<Label> DoorList::LabelCopies(bool (Door::*getLabel)(Label&) const) const
+{
+    enum class Made : uint8_t { NotYet, Yes, None };
+    std::pmr::vector<Label> shared(m_groups.Size(), m_memory);
+    std::pmr::vector<Made> made(m_groups.Size(), Made::NotYet, m_memory);
+    std::pmr::vector<Label> label_list(m_memory);
 
-    for (const auto& door : m_doors)
+    for (size_t i = 0; i < m_view.size(); ++i)
     {
-        if (door.getConstruction() == Construction::Shaker || door.getConstruction() == Construction::SmallShaker)
-            door.AppendTigerStopCuts(cutlist);
+        const uint32_t group = m_groups.GroupOf(i);
+        if (made[group] == Made::NotYet)
+            made[group] = (m_view[i].*getLabel)(shared[group]) ? Made::Yes : Made::None;
+        if (made[group] == Made::Yes)
+            m_view[i].AppendLabelCopies(shared[group], label_list);
     }
-    WriteGroupedCSVs(cutlist, jobname);
+    return label_list;
 }
 
 void DoorList::WriteShakerLabelCsv(const std::string& jobname) const
 {
-    std::vector<Shaker_CSV_Label> label_list;
-
-    for (const auto& door : m_doors)
-    {
-        door.AppendShakerLabel(label_list);
-    }
+    const std::pmr::vector<Shaker_CSV_Label> label_list = LabelCopies(&Door::GetShakerLabel);
 
     const std::string filename = "LabelsList.csv";
-    std::ofstream csv_outfile(filename);
+    if (!ShouldWrite(filename))
+        return;
+    std::ofstream csv_outfile(OutputPath(filename));
     if (!csv_outfile)
         return;
 
@@ -949,15 +1534,12 @@ void DoorList::WriteShakerLabelCsv(const std::string& jobname) const
 
 void DoorList::WriteSlabLabelCsv(const std::string& jobname) const
 {
-    std::vector<Slab_CSV_Label> label_list;
-
-    for (const auto& door : m_doors)
-    {
-        door.AppendSlabLabel(label_list);
-    }
+    const std::pmr::vector<Slab_CSV_Label> label_list = LabelCopies(&Door::GetSlabLabel);
 
     const std::string filename = "SlabLabelsList.csv";
-    std::ofstream csv_outfile(filename);
+    if (!ShouldWrite(filename))
+        return;
+    std::ofstream csv_outfile(OutputPath(filename));
     if (!csv_outfile)
         return;
 
@@ -972,14 +1554,205 @@ void DoorList::WriteSlabLabelCsv(const std::string& jobname) const
     }
 }
 
-DoorList::DoorList(CsvTable doorsTable)
+// Every field that can reach an output, hashed one by one so padding
+// bytes never count.
+uint64_t Door::ContentHash() const
+{
+    uint64_t hash = Snapshot::HashSeed;
+    auto add = [&](const auto& value)
+        {
+            hash = Snapshot::HashBytes({ reinterpret_cast<const char*>(&value), sizeof(value) }, hash);
+        };
+    auto addText = [&](const DoorString& text)
+        {
+            hash = Snapshot::HashBytes(text.View(), hash);
+            add('\0');
+        };
+
+    addText(name);
+    addText(label);
+    addText(material);
+    addText(notes);
+    add(dimensions.finishedWidth);
+    add(dimensions.finishedHeight);
+    add(dimensions.oversizeWidth);
+    add(dimensions.oversizeHeight);
+    add(dimensions.bonedetail);
+    for (Length width : dimensions.shakerparts.width)
+        add(width);
+    add(dimensions.shakerparts.rabbet);
+    add(dimensions.shakerparts.stick_tolerance);
+    add(dimensions.shakerparts.cope_tolerance);
+    add(dimensions.shakerparts.mid_rail_count);
+    add(dimensions.shakerparts.mid_stile_count);
+    add(dimensions.panel.orientation);
+    add(dimensions.panel.hasPanel);
+    add(quantity);
+    add(construction);
+    add(type);
+    return hash;
+}
+
+// Mixes in the registered styles and the validation limits: doors with
+// the same fields get other geometry under other styles, and other limits
+// keep other doors and warn about others
+static uint64_t HashDefinitions(uint64_t hash)
+{
+    const uint64_t styles = StyleRegistry::Global().Fingerprint();
+    hash = Snapshot::HashBytes({ reinterpret_cast<const char*>(&styles), sizeof(styles) }, hash);
+    const uint64_t limits = ValidationRules::Global().Fingerprint();
+    return Snapshot::HashBytes({ reinterpret_cast<const char*>(&limits), sizeof(limits) }, hash);
+}
+
+static std::string ManifestPath(const std::string& jobname)
+{
+    return jobname + " Outputs.manifest";
+}
+
+// Doors are keyed by their label, which makeUniqueLabels has made unique;
+// usable comes back false if two doors still share one.
+JobManifest DoorList::BuildManifest(const std::string& jobname, bool& usable) const
+{
+    JobManifest manifest;
+    usable = true;
+
+    // Every output is rewritten once the style or limit definitions change
+    const uint64_t job = HashDefinitions(Snapshot::HashBytes(jobname));
+    const uint64_t dated = Snapshot::HashBytes(ReportDate(), job);
+    // Switching the report layout rewrites the report
+    const uint64_t reportInputs = m_consolidated ? Snapshot::HashBytes("consolidated", dated) : dated;
+    const std::string doorReport = jobname + " Door Report.html";
+    const std::string tigerStopReport = jobname + " TigerStop Report.html";
+    manifest.AddOutput(doorReport, reportInputs);
+
+    // The outputs a door goes into depend on its build only, so they are
+    // listed once per group and replayed for every member
+    using Contribution = std::pair<std::string, uint64_t>;
+    std::vector<std::vector<Contribution>> outputsOf(m_groups.Size());
+    std::pmr::vector<TigerStopItem> cuts(m_memory);
+    Shaker_CSV_Label shakerLabel;
+    Slab_CSV_Label slabLabel;
+
+    for (size_t i = 0; i < m_view.size(); ++i)
+    {
+        const Door& door = m_view[i];
+        std::vector<Contribution>& outputs = outputsOf[m_groups.GroupOf(i)];
+        if (outputs.empty())
+        {
+            outputs.emplace_back(doorReport, reportInputs);
+
+            cuts.clear();
+            if (door.Style().hasFrame)
+                door.AppendTigerStopCuts(cuts, door.getQuantity());
+            if (!cuts.empty())
+                outputs.emplace_back(tigerStopReport, dated);
+            for (const auto& cut : cuts)
+                outputs.emplace_back(TigerStopCsvPath(jobname, m_materials[cut.material], cut.group, cut.nominal_width).string(), job);
+
+            if (door.GetShakerLabel(shakerLabel))
+                outputs.emplace_back("LabelsList.csv", job);
+            if (door.GetSlabLabel(slabLabel))
+                outputs.emplace_back("SlabLabelsList.csv", job);
+
+            const std::filesystem::path panelCsv = PanelCsvPath(jobname, m_materials[door.GetMaterialId()], GetPanelList(door));
+            if (!panelCsv.empty())
+                outputs.emplace_back(panelCsv.string(), job);
+        }
+
+        const uint64_t key = Snapshot::HashBytes(door.LabelView());
+        usable = manifest.AddDoor(key, door.ContentHash()) && usable;
+        for (const auto& [output, inputs] : outputs)
+            manifest.AddContributor(output, inputs, key);
+    }
+
+    return manifest;
+}
+
+void DoorList::PlanOutputs(const std::string& jobname)
+{
+    bool usable = false;
+    m_manifest = BuildManifest(jobname, usable);
+
+    JobManifest previous;
+    m_incremental = usable && previous.Load(OutputPath(ManifestPath(jobname)).string());
+    if (!m_incremental)
+        return;
+
+    m_staleOutputs = m_manifest.StaleOutputs(previous, m_outputRoot);
+    m_log << "Rewriting " << m_staleOutputs.size() << " of " << m_manifest.OutputCount()
+        << " output file(s), the rest are unchanged\n";
+}
+
+void DoorList::SaveOutputManifest(const std::string& jobname) const
+{
+    m_manifest.Save(OutputPath(ManifestPath(jobname)).string());
+}
+
+bool DoorList::ShouldWrite(const std::filesystem::path& output) const
+{
+    return !m_incremental || m_staleOutputs.contains(output.string());
+}
+
+DoorList::DoorList(const CsvTable& doorsTable, std::ostream& log, std::pmr::memory_resource* memory)
+    : m_log(log), m_memory(memory)
 {
     ReadCsvTable(doorsTable);
 }
 
+DoorList::DoorList(const std::string& csvPath, std::ostream& log, std::pmr::memory_resource* memory)
+    : m_log(log), m_memory(memory)
+{
+    Snapshot::SourceStamp source;
+    const bool stamped = Snapshot::StampSource(csvPath, source);
+    // A snapshot is only reused under the same style and limit definitions
+    source.hash = HashDefinitions(source.hash);
+
+    if (stamped && LoadSnapshot(csvPath, source))
+        return;
+
+    ReadCsvFile(csvPath);
+
+    if (stamped && !m_doors.empty())
+        WriteSnapshot(csvPath, source);
+}
+
+bool DoorList::LoadSnapshot(const std::string& csvPath, const Snapshot::SourceStamp& source)
+{
+    m_view = Snapshot::Map<Door>(Snapshot::PathFor(csvPath), DOOR_SNAPSHOT_VERSION, source, m_snapshot);
+    if (m_view.empty())
+        return false;
+
+    // Materials were interned in door order, so interning them again in the
+    // same order hands every door back the ID it was saved with
+    for (const auto& door : m_view)
+    {
+        if (m_materials.Intern(door.MaterialView()) != door.GetMaterialId())
+        {
+            m_view = {};
+            m_materials = {};
+            m_snapshot.Close();
+            return false;
+        }
+    }
+
+    // Saved doors passed the same limits, so this only finds warnings
+    std::vector<uint8_t> removed;
+    m_diagnostics = ValidationRules::Global().Validate(m_view, removed);
+
+    m_groups.Build(m_view);
+    m_log << "Processed " << m_view.size() << " valid door(s) from snapshot, CSV unchanged\n";
+    return true;
+}
+
+// A snapshot that cannot be written only costs the next run a full parse.
+void DoorList::WriteSnapshot(const std::string& csvPath, const Snapshot::SourceStamp& source) const
+{
+    Snapshot::Write<Door>(Snapshot::PathFor(csvPath), DOOR_SNAPSHOT_VERSION, source, m_view);
+}
+
 void DoorList::Print()
 {
-    for (const auto& door : m_doors)
+    for (const auto& door : m_view)
         door.Print();
 }
 
@@ -989,116 +1762,49 @@ void DoorList::makeUniqueLabels()
 
     // ---- PASS 1: count frequencies ----
     for (auto& d : m_doors)
-        ++totalCount[d.getlabelPtr()];
+        ++totalCount[std::string(d.LabelView())];
 
     std::unordered_map<std::string, int> seen;
 
     // ---- PASS 2: assign suffixes if needed ----
     for (auto& d : m_doors)
     {
-        std::string base = d.getlabelPtr();
+        const std::string base(d.LabelView());
+        const bool glass = !d.hasPanel() && d.Style().hasFrame;
+        const bool repeated = totalCount[base] > 1;
+        if (!repeated && !glass)
+            continue;
 
+        DoorString relabeled;
+        bool fits = relabeled.Append(glass ? "G_" : "");
+        fits = relabeled.Append(base) && fits;
 
-        if (totalCount[base] > 1)
+        if (repeated)
         {
-            int idx = seen[base]++;
-
-            if (!d.hasPanel() && d.getConstruction() != Construction::Slab)
-            {
-                base = "G_" + base;
-            }
-
             // convert idx -> A,B,C,... AA,AB...
-            int n = idx;
-            std::string suffix;
-
+            char suffix[16];
+            char* first = std::end(suffix);
+            int n = seen[base]++;
             do
             {
-                suffix.insert(suffix.begin(), char('A' + (n % 26)));
+                *--first = char('A' + (n % 26));
                 n = n / 26 - 1;
             } while (n >= 0);
-
-            std::snprintf(d.getlabelPtr(), MAXTEXTSIZE, "%s%s",
-                base.c_str(), suffix.c_str());
+            fits = relabeled.Append(std::string_view(first, std::end(suffix) - first)) && fits;
         }
-        else if (!d.hasPanel() && d.getConstruction() != Construction::Slab)
-        {
-            base = "G_" + base;
 
-            std::snprintf(d.getlabelPtr(), MAXTEXTSIZE, "%s",
-                base.c_str());
-        }
+        if (!fits)
+            m_log << "Warning: Label " << base << " is longer than " << DoorString::Capacity
+                << " characters once made unique, cut to " << relabeled.View() << "\n";
+        d.SetLabel(relabeled);
     }
 }
 
-void DoorList::OverSize_SanityCheck()
+void DoorList::OverSize_SanityCheck() const
 {
-    int denom = 32;
-    for (auto& d : m_doors)
+    for (const DoorDiagnostic& diagnostic : m_diagnostics)
     {
-        if (d.getConstruction() == Construction::Slab)
-        {
-            if (d.getOversizeWidth() > 0.0)
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Width: " << d.getOversizeWidth() << " is greater than 0 for Slab type! \n"
-                << std::endl;
-            }
-            if (d.getOversizeHeight() > 0.0)
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Height: " << d.getOversizeHeight() << " is greater than 0 for Slab type! \n"
-                << std::endl;
-            }
-            if (d.getOversizeWidth() < -0.0625)
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Width: " << d.getOversizeWidth() << " is less than 0.0625 for Slab type! \n"
-                    << std::endl;
-            }
-            if (d.getOversizeHeight() < -0.0625)
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Height: " << d.getOversizeHeight() << " is greater than 0.0625 for Slab type! \n"
-                    << std::endl;
-            }
-            if (d.getOversizeWidth() != d.getOversizeHeight())
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Width and Height do not match for Slab type! \n"
-                    << "Oversize Width: " << d.getOversizeWidth() << " Oversize Height: " << d.getOversizeHeight() << " \n"
-                    << std::endl;
-            }
-        }
-        if (d.getConstruction() == Construction::Shaker)
-        {
-            if (d.getOversizeWidth() < 0.0)
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Width: " << d.getOversizeWidth() << " is negative on Shaker type! \n"
-                    << std::endl;
-            }
-            if (d.getOversizeHeight() < 0.0)
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Height: " << d.getOversizeHeight() << " is negative on Shaker type! \n"
-                    << std::endl;
-            }
-        }
-        if (d.getConstruction() == Construction::SmallShaker)
-        {
-            if (d.getOversizeWidth() != 0.0)
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Width: " << d.getOversizeWidth() << " is not 0 for Small Shaker type! \n"
-                    << std::endl;
-            }
-            if (d.getOversizeHeight() != 0.0)
-            {
-                std::cout << "Warning!! " << d.getNameString() << ", (" << d.getFinishedWidthString(denom) << " by " << d.getFinishedHeightString(denom) << ") \n"
-                    << "Oversize Height: " << d.getOversizeHeight() << " is not 0 for Small Shaker type! \n"
-                    << std::endl;
-            }
-        }
+        if (!diagnostic.removed)
+            m_log << diagnostic.text << "\n";
     }
 }
\ No newline at end of file
@@ -1,14 +1,30 @@
-#pragma once
+﻿#pragma once
 #include <string> 
 #include <vector>
-#include <format>
+#include <charconv>
+#include <span>
+#include <array>
+#include <iterator>
+#include <algorithm>
+#include <set>
+#include <memory_resource>
+#include <filesystem>
+#include <iostream>
 #include "CsvUtils.h"
 #include "HTML.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
+#include "JobManifest.h"
+#include "StringTable.h"
+#include "Length.h"
+#include "FixedString.h"
 
 //constants
 constexpr size_t MAXTEXTSIZE = 64;
-constexpr double ALLOWANCE = 0.015625;
-constexpr double RABBET_ALLOWANCE = 0.0625;
+using DoorString = FixedString<MAXTEXTSIZE>;	// a door's name, label, material or notes
+constexpr Length ALLOWANCE = Length::FromInches(0.015625);
+constexpr Length RABBET_ALLOWANCE = Length::FromInches(0.0625);
+constexpr uint32_t DOOR_SNAPSHOT_VERSION = 5;	// bump whenever Door's layout changes
 
 //struct forward declarations
 struct CsvRow;
@@ -25,6 +41,7 @@ enum class ShakerPart;
 //function forward declarations
 inline std::string MakeTigerStopFilename(StockGroup group, double width, std::string jobname);
 inline std::string FormatTrimmed(double value);
+inline std::string FormatTrimmed(Length value);
 inline StockGroup GetStockGroup(ShakerPart part);
 
 //struct definitions
@@ -43,6 +60,8 @@ enum class FaceType
 	Panel
 };
 
+// A door style's ID in StyleRegistry. The code styles come first, in this
+// order; styles loaded from a config file follow them.
 enum class Construction
 {
 	Slab,
@@ -67,13 +86,75 @@ enum class ShakerPart
 	SHAKERPARTCOUNT
 };
 
+// Columns of the door export, in the order Door::Create reads them.
+// DoorColumns must list them in the same order.
+enum class DoorColumn
+{
+	Name,
+	CabNumber,
+	Notes,
+	Material,
+	Count,
+	ActualWidth,
+	ActualHeight,
+	Type,
+	Construction,
+	WidthOversize,
+	HeightOversize,
+	Rabbet,
+	BoneDetail,
+	BottomRail,
+	TopRail,
+	LeftStile,
+	RightStile,
+	MidRailStile,
+	StickTolerance,
+	CopeTolerance,
+	MidRailCount,
+	MidStileCount,
+	GrainDirection,
+	Panel,
+	COUNT
+};
+
+// A door cannot be built without the required columns, so a file missing
+// any of them is rejected before its rows are read.
+inline constexpr CsvColumn DoorColumns[] =
+{
+	{ "Name" },
+	{ "Cab#" },
+	{ "Notes" },
+	{ "Material" },
+	{ "Count", true },
+	{ "Actual Width", true },
+	{ "Actual Height", true },
+	{ "Type", true },
+	{ "Construction", true },
+	{ "WidthOversize" },
+	{ "HeightOversize" },
+	{ "Rabbet" },
+	{ "Bone Detail" },
+	{ "Bottom Rail" },
+	{ "Top Rail" },
+	{ "Left Stile" },
+	{ "Right Stile" },
+	{ "Mid Rail/Stile" },
+	{ "StickTolerance" },
+	{ "CopeTolerance" },
+	{ "Mid Rail Count" },
+	{ "Mid Stile Count" },
+	{ "Grain Direction" },
+	{ "Panel" }
+};
+static_assert(std::size(DoorColumns) == static_cast<size_t>(DoorColumn::COUNT), "DoorColumns out of sync with DoorColumn");
+
 struct TigerStopItem
 {
 	StockGroup group;
-	std::string material;
-	double length;
+	uint32_t material;	// ID in DoorList's material table
+	Length length;
 	unsigned int quantity;
-	double nominal_width;
+	Length nominal_width;
 };
 
 struct Shaker_CSV_Label
@@ -92,36 +173,358 @@ struct Slab_CSV_Label
 	std::string notes;
 };
 
+// One door's frame as the construction rules see it: the oversized door,
+// the nominal part widths from the CSV and the joinery allowances.
+struct DoorFrame
+{
+	Length doorWidth;
+	Length doorHeight;
+	Length width[static_cast<int>(ShakerPart::SHAKERPARTCOUNT)] = {};
+	Length rabbet;
+	Length stick;
+	Length cope;
+	int64_t midRails = 0;
+	int64_t midStiles = 0;
+
+	constexpr Length operator[](ShakerPart part) const { return width[static_cast<int>(part)]; }
+};
+
+// How DoorStore works out the geometry of a style's doors: with one of the
+// rules types below, or from the style's compiled formula table
+enum class StyleKernel
+{
+	Slab,
+	Shaker,
+	SmallShaker,
+	Table
+};
+
+// Geometry rules of the code styles. The three types have the same static
+// members, so code templated on one (DoorStore's batch evaluator) compiles
+// to a straight loop for that construction.
+//   hasFrame        rails and stiles are cut, and panels can be split
+//   countsMidParts  mid rails and stiles count towards the rail/stile total
+//   rabbetedPanel   the panel is cut to sit in the rabbet on each side
+// Mid rail and stile lengths are only used for doors that have them.
+struct SlabRules
+{
+	static constexpr StyleKernel kernel = StyleKernel::Slab;
+	static constexpr bool hasFrame = false;
+	static constexpr bool countsMidParts = false;
+	static constexpr bool rabbetedPanel = false;
+
+	static constexpr Length PartWidth(const DoorFrame& f, ShakerPart part) { return f[part]; }
+	static constexpr Length MidPartWidth(const DoorFrame& f, ShakerPart part) { return f[part]; }
+	static constexpr Length RailLength(const DoorFrame&) { return Length(); }
+	static constexpr Length StileLength(const DoorFrame&) { return Length(); }
+	static constexpr Length MidStileLength(const DoorFrame&) { return Length(); }
+	static constexpr Length PanelWidth(const DoorFrame& f) { return f.doorWidth; }
+	static constexpr Length PanelHeight(const DoorFrame& f) { return f.doorHeight; }
+};
+
+struct ShakerRules
+{
+	static constexpr StyleKernel kernel = StyleKernel::Shaker;
+	static constexpr bool hasFrame = true;
+	static constexpr bool countsMidParts = true;
+	static constexpr bool rabbetedPanel = true;
+
+	// Parts lose the stick tolerance on each edge that meets another part
+	static constexpr Length PartWidth(const DoorFrame& f, ShakerPart part) { return f[part] - f.stick; }
+	static constexpr Length MidPartWidth(const DoorFrame& f, ShakerPart part) { return f[part] - (f.stick * 2); }
+
+	// Rails run between the stiles
+	static constexpr Length RailLength(const DoorFrame& f)
+	{
+		return f.doorWidth - PartWidth(f, ShakerPart::LEFT_STILE) - PartWidth(f, ShakerPart::RIGHT_STILE) + (f.rabbet * 2) + f.cope * 2;
+	}
+	static constexpr Length StileLength(const DoorFrame& f) { return f.doorHeight; }
+	// Mid stiles run between the rails, less any mid rails
+	static constexpr Length MidStileLength(const DoorFrame& f)
+	{
+		return f.doorHeight - PartWidth(f, ShakerPart::TOP_RAIL) - PartWidth(f, ShakerPart::BOTTOM_RAIL) - (MidPartWidth(f, ShakerPart::MID_RAIL) * f.midRails) + (f.rabbet * 2) + f.cope * 2;
+	}
+	static constexpr Length PanelWidth(const DoorFrame& f)
+	{
+		Length panelWidth = f.doorWidth - PartWidth(f, ShakerPart::LEFT_STILE) - PartWidth(f, ShakerPart::RIGHT_STILE) - MidPartWidth(f, ShakerPart::MID_STILE) * f.midStiles - ALLOWANCE;
+		return panelWidth / (f.midStiles + 1);
+	}
+	static constexpr Length PanelHeight(const DoorFrame& f)
+	{
+		Length panelHeight = f.doorHeight - PartWidth(f, ShakerPart::TOP_RAIL) - PartWidth(f, ShakerPart::BOTTOM_RAIL) - MidPartWidth(f, ShakerPart::MID_RAIL) * f.midRails - ALLOWANCE;
+		return panelHeight / (f.midRails + 1);
+	}
+};
+
+struct SmallShakerRules
+{
+	static constexpr StyleKernel kernel = StyleKernel::SmallShaker;
+	static constexpr bool hasFrame = true;
+	static constexpr bool countsMidParts = false;
+	static constexpr bool rabbetedPanel = false;
+
+	static constexpr Length PartWidth(const DoorFrame& f, ShakerPart part) { return f[part]; }
+	static constexpr Length MidPartWidth(const DoorFrame& f, ShakerPart part) { return f[part]; }
+	static constexpr Length RailLength(const DoorFrame& f) { return f.doorWidth; }
+	static constexpr Length StileLength(const DoorFrame& f) { return f.doorHeight; }
+	static constexpr Length MidStileLength(const DoorFrame& f) { return f.doorHeight; }
+	static constexpr Length PanelWidth(const DoorFrame& f) { return f.doorWidth - PartWidth(f, ShakerPart::LEFT_STILE) - PartWidth(f, ShakerPart::RIGHT_STILE); }
+	static constexpr Length PanelHeight(const DoorFrame& f) { return f.doorHeight - PartWidth(f, ShakerPart::TOP_RAIL) - PartWidth(f, ShakerPart::BOTTOM_RAIL); }
+};
+
+// Cut length of one part under Rules; 0 for mid parts the door does not have
+template <typename Rules>
+constexpr Length CutLength(const DoorFrame& f, ShakerPart part)
+{
+	switch (part)
+	{
+	case ShakerPart::TOP_RAIL:
+	case ShakerPart::BOTTOM_RAIL:
+		return Rules::RailLength(f);
+	case ShakerPart::MID_RAIL:
+		return f.midRails == 0 ? Length() : Rules::RailLength(f);
+	case ShakerPart::LEFT_STILE:
+	case ShakerPart::RIGHT_STILE:
+		return Rules::StileLength(f);
+	case ShakerPart::MID_STILE:
+		return f.midStiles == 0 ? Length() : Rules::MidStileLength(f);
+	default:
+		return Length();
+	}
+}
+
+// Width of one part under Rules, as it is left after joinery
+template <typename Rules>
+constexpr Length PartWidth(const DoorFrame& f, ShakerPart part)
+{
+	switch (part)
+	{
+	case ShakerPart::TOP_RAIL:
+	case ShakerPart::BOTTOM_RAIL:
+	case ShakerPart::LEFT_STILE:
+	case ShakerPart::RIGHT_STILE:
+		return Rules::PartWidth(f, part);
+	case ShakerPart::MID_RAIL:
+	case ShakerPart::MID_STILE:
+		return Rules::MidPartWidth(f, part);
+	default:
+		return Length();
+	}
+}
+
+// Lengths a style formula can name. The part widths are the nominal ones
+// from the CSV, in ShakerPart order.
+enum class StyleLength
+{
+	DoorWidth,
+	DoorHeight,
+	TopRail,
+	BottomRail,
+	LeftStile,
+	RightStile,
+	MidRail,
+	MidStile,
+	Rabbet,
+	Stick,
+	Cope,
+	Allowance,
+	COUNT
+};
+
+// What a formula term is multiplied by besides its coefficient
+enum class StyleCount
+{
+	One,
+	MidRails,
+	MidStiles,
+	COUNT
+};
+
+// What a formula is divided by, rounding to the nearest tick
+enum class StyleDivisor
+{
+	One,
+	PanelsAcross,	// mid stiles + 1
+	PanelsDown		// mid rails + 1
+};
+
+constexpr size_t StyleTermCount = static_cast<size_t>(StyleLength::COUNT) * static_cast<size_t>(StyleCount::COUNT);
+using StyleTerms = std::array<int64_t, StyleTermCount>;
+
+// One length of a config style, compiled from text such as
+//   (door_width - left_stile - right_stile - allowance) / panels_across
+// into a whole-number coefficient for every length and length-times-count
+// term, plus a constant. A door evaluates it as a dot product with its
+// StyleTerms, with no parsing or lookup, and exactly: only the divisor rounds.
+struct StyleFormula
+{
+	int32_t coeff[StyleTermCount] = {};
+	Length constant;
+	StyleDivisor divisor = StyleDivisor::One;
+
+	static constexpr size_t Term(StyleLength length, StyleCount count = StyleCount::One)
+	{
+		return static_cast<size_t>(count) * static_cast<size_t>(StyleLength::COUNT) + static_cast<size_t>(length);
+	}
+
+	// The formula naming a single length
+	static StyleFormula Of(StyleLength length)
+	{
+		StyleFormula formula;
+		formula.coeff[Term(length)] = 1;
+		return formula;
+	}
+
+	Length Evaluate(const StyleTerms& terms, const DoorFrame& f) const
+	{
+		int64_t ticks = constant.Ticks();
+		for (size_t t = 0; t < StyleTermCount; ++t)
+			ticks += coeff[t] * terms[t];
+
+		const int64_t divisor_ = divisor == StyleDivisor::PanelsAcross ? f.midStiles + 1
+			: divisor == StyleDivisor::PanelsDown ? f.midRails + 1 : 1;
+		return Length::FromTicks(ticks) / divisor_;
+	}
+};
+
+// Every term a formula can use, in ticks, for one door
+inline StyleTerms GetStyleTerms(const DoorFrame& f)
+{
+	constexpr size_t lengthCount = static_cast<size_t>(StyleLength::COUNT);
+	const int64_t base[lengthCount] =
+	{
+		f.doorWidth.Ticks(),
+		f.doorHeight.Ticks(),
+		f.width[0].Ticks(), f.width[1].Ticks(), f.width[2].Ticks(),
+		f.width[3].Ticks(), f.width[4].Ticks(), f.width[5].Ticks(),
+		f.rabbet.Ticks(),
+		f.stick.Ticks(),
+		f.cope.Ticks(),
+		ALLOWANCE.Ticks()
+	};
+
+	StyleTerms terms;
+	for (size_t l = 0; l < lengthCount; ++l)
+	{
+		terms[StyleFormula::Term(static_cast<StyleLength>(l))] = base[l];
+		terms[StyleFormula::Term(static_cast<StyleLength>(l), StyleCount::MidRails)] = base[l] * f.midRails;
+		terms[StyleFormula::Term(static_cast<StyleLength>(l), StyleCount::MidStiles)] = base[l] * f.midStiles;
+	}
+	return terms;
+}
+
+// Panel and slab cut lists; each material has one of each. Doors of a
+// style whose list is Shaker only go into it when they have a panel.
+enum class PanelList
+{
+	Shaker,
+	SmallShaker,
+	Slab,
+	None
+};
+
+// Label CSV a style's doors go into. Shaker labels are only made for doors
+// with a panel.
+enum class LabelList
+{
+	Shaker,
+	Slab
+};
+
+// How a style's rails and stiles are grouped into TigerStop stock
+enum class StockGrouping
+{
+	ByPart,				// rails and stiles apart
+	SmallShakerRail		// all of them together
+};
+
+// Oversize a style's doors are expected to have; the sanity check warns
+// about doors outside it
+enum class OversizeRule
+{
+	Slab,			// none, or an undersize of up to 1/16" that is the same both ways
+	Shaker,			// none or more
+	SmallShaker		// none
+};
+
+// Everything that differs between door styles. Code styles take their
+// geometry from a rules type and their flags from it (FromRules); config
+// styles compute it from the formula table.
+struct ConstructionStyle
+{
+	static constexpr size_t PartCount = static_cast<size_t>(ShakerPart::SHAKERPARTCOUNT);
+
+	std::string keyword;	// the Construction column value, upper case
+	std::string name;		// as shown in reports and warnings
+	StyleKernel kernel = StyleKernel::Table;
+	bool hasFrame = false;
+	bool countsMidParts = false;
+	bool rabbetedPanel = false;
+	bool requiredWidth[PartCount] = {};		// DoorRule::RequiredPartWidth removes doors without these
+	Html::Svg::DoorStyle drawing = Html::Svg::DoorStyle::Slab;
+	PanelList panelList = PanelList::Slab;
+	LabelList labels = LabelList::Slab;
+	StockGrouping stock = StockGrouping::ByPart;
+	OversizeRule oversize = OversizeRule::Shaker;
+
+	// Table kernel only
+	StyleFormula width[PartCount];		// as PartWidth<Rules>
+	StyleFormula length[PartCount];		// as CutLength<Rules>
+	StyleFormula panelWidth;			// across the door, before the grain is applied
+	StyleFormula panelHeight;
+
+	// Copies the kernel and geometry flags of a rules type into style
+	template <typename Rules>
+	static ConstructionStyle FromRules(ConstructionStyle style)
+	{
+		style.kernel = Rules::kernel;
+		style.hasFrame = Rules::hasFrame;
+		style.countsMidParts = Rules::countsMidParts;
+		style.rabbetedPanel = Rules::rabbetedPanel;
+		return style;
+	}
+};
+
+// The door styles a Construction value can name. It starts with the code
+// styles; LoadFile adds the ones a config file defines. Styles are only
+// added at startup: once doors are being read the registry is read-only, so
+// concurrent jobs share it without locking.
+class StyleRegistry
+{
+public:
+	StyleRegistry();
+
+	// The registry doors are read against
+	static StyleRegistry& Global();
+
+	// Returns false if a style already uses the keyword
+	bool Add(ConstructionStyle style);
+	// Keywords are matched upper case
+	bool Find(std::string_view keyword, Construction& out) const;
+	const ConstructionStyle& operator[](Construction c) const { return m_styles[static_cast<size_t>(c)]; }
+	size_t Size() const { return m_styles.size(); }
+
+	// Hash of every style definition, so that data worked out under one set
+	// of styles is not reused under another
+	uint64_t Fingerprint() const;
+
+	// Adds every style of a config file, or none if it has errors, which are
+	// logged with their line numbers
+	bool LoadFile(const std::string& path, std::ostream& log);
+
+private:
+	std::vector<ConstructionStyle> m_styles;
+	StringTable m_keywords;		// ID i is the keyword of style i
+};
+
 struct ShakerParts
 {
-	double width[static_cast<int>(ShakerPart::SHAKERPARTCOUNT)] = {};
-	double rabbet = 0.0;
-	double stick_tolerance = 0.0;
-	double cope_tolerance = 0.0;
+	Length width[static_cast<int>(ShakerPart::SHAKERPARTCOUNT)] = {};
+	Length rabbet;
+	Length stick_tolerance;
+	Length cope_tolerance;
 	unsigned int mid_rail_count = 0;
 	unsigned int mid_stile_count = 0;
-	double GetPartWidth(ShakerPart part, Construction con) const
-	{ 
-		double adjustment = 0.0;
-		if (con == Construction::Shaker)
-		{
-			adjustment = stick_tolerance;
-		}
-
-		switch(part)
-		{
-		case ShakerPart::TOP_RAIL:
-		case ShakerPart::BOTTOM_RAIL:
-		case ShakerPart::LEFT_STILE:
-		case ShakerPart::RIGHT_STILE:
-			return width[static_cast<int>(part)] - adjustment;
-		case ShakerPart::MID_RAIL:
-		case ShakerPart::MID_STILE:
-			return width[static_cast<int>(part)] - (adjustment * 2.0);
-		default:
-			return 0.0;
-		}
-	}
 	std::string GetPartString(ShakerPart part) const
 	{
 		std::string name = "";
@@ -143,405 +546,188 @@ struct ShakerParts
 			return "undefined part";
 		}
 	}
-	double GetCutLength(Construction construction, ShakerPart part, double doorWidth, double doorHeight) const
-	{
-		if (construction == Construction::Shaker)
-		{
-			switch (part)
-			{
-			case ShakerPart::TOP_RAIL:
-			case ShakerPart::BOTTOM_RAIL:
-				return doorWidth - GetPartWidth(ShakerPart::LEFT_STILE, construction) - GetPartWidth(ShakerPart::RIGHT_STILE, construction) + (rabbet * 2) + cope_tolerance * 2;
-			case ShakerPart::MID_RAIL:
-				if (mid_rail_count == 0)
-					return 0.0;
-				return doorWidth - GetPartWidth(ShakerPart::LEFT_STILE, construction) - GetPartWidth(ShakerPart::RIGHT_STILE, construction) + (rabbet * 2) + cope_tolerance * 2;
-			case ShakerPart::LEFT_STILE:
-			case ShakerPart::RIGHT_STILE:
-				return doorHeight;
-			case ShakerPart::MID_STILE:
-				if (mid_stile_count == 0)
-					return 0.0;
-				return doorHeight - GetPartWidth(ShakerPart::TOP_RAIL, construction) - GetPartWidth(ShakerPart::BOTTOM_RAIL, construction) - (GetPartWidth(ShakerPart::MID_RAIL, construction) * mid_rail_count) + (rabbet * 2) + cope_tolerance * 2;
-			default:
-				return 0.0;
-			}
-		}
-		else if (construction == Construction::SmallShaker)
-		{
-			switch (part)
-			{
-			case ShakerPart::TOP_RAIL:
-			case ShakerPart::BOTTOM_RAIL:
-				return doorWidth;
-			case ShakerPart::MID_RAIL:
-				if (mid_rail_count == 0)
-					return 0.0;
-				return doorWidth;
-			case ShakerPart::LEFT_STILE:
-			case ShakerPart::RIGHT_STILE:
-				return doorHeight;
-			case ShakerPart::MID_STILE:
-				if (mid_stile_count == 0)
-					return 0.0;
-				return doorHeight;
-			default:
-				return 0.0;
-			}
-		}
-		return 0.0;
-	}
+	bool operator==(const ShakerParts&) const = default;
 };
 
 struct Panel
 {
 	Orientation orientation = Orientation::VERTICAL;
 	bool hasPanel = false;
-private:
-	double getWidth(Construction cons, ShakerParts parts, double doorWidth) const
-	{
-		if (cons == Construction::Shaker)
-		{
-			double panelWidth = doorWidth - parts.GetPartWidth(ShakerPart::LEFT_STILE, cons) - parts.GetPartWidth(ShakerPart::RIGHT_STILE, cons) - parts.GetPartWidth(ShakerPart::MID_STILE, cons) * parts.mid_stile_count - ALLOWANCE;
-			return (panelWidth / (parts.mid_stile_count + 1));
-		}
-		if (cons == Construction::SmallShaker)
-			return doorWidth - parts.GetPartWidth(ShakerPart::LEFT_STILE, cons) - parts.GetPartWidth(ShakerPart::RIGHT_STILE, cons);
-		return doorWidth;
-	}
-	double getHeight(Construction cons, ShakerParts parts, double doorHeight) const
-	{
-		if (cons == Construction::Shaker)
-		{
-			double panelHeight = doorHeight - parts.GetPartWidth(ShakerPart::TOP_RAIL, cons) - parts.GetPartWidth(ShakerPart::BOTTOM_RAIL, cons) - parts.GetPartWidth(ShakerPart::MID_RAIL, cons) * parts.mid_rail_count - ALLOWANCE;
-			return panelHeight / (parts.mid_rail_count + 1);
-		}
-		if (cons == Construction::SmallShaker)
-			return doorHeight - parts.GetPartWidth(ShakerPart::TOP_RAIL, cons) - parts.GetPartWidth(ShakerPart::BOTTOM_RAIL, cons);
-		return doorHeight;
-	}
-public:
-	double GetPanelWidth(Construction cons, ShakerParts parts, double doorWidth, double doorHeight, bool useOrientation = true) const
-	{
-		if (useOrientation)
-		{
-			if (orientation == Orientation::VERTICAL)
-				return getWidth(cons, parts, doorWidth);
-			else
-				return getHeight(cons, parts, doorHeight);
-		}
-		return getWidth(cons, parts, doorWidth);
-	}
-	double GetPanelHeight(Construction cons, ShakerParts parts, double doorWidth, double doorHeight, bool useOrientation = true) const
-	{
-		if (useOrientation)
-		{
-			if (orientation == Orientation::VERTICAL)
-				return getHeight(cons, parts, doorHeight);
-			else
-				return getWidth(cons, parts, doorWidth);
-		}
-		return getHeight(cons, parts, doorHeight);
-	}
-	unsigned int GetPanelCount(Construction cons, ShakerParts parts) const
-	{
-		if (hasPanel && (cons == Construction::Shaker || cons == Construction::SmallShaker))
-			return (parts.mid_rail_count + 1) * (parts.mid_stile_count + 1);
-		else
-			return 1;
-	}
+	bool operator==(const Panel&) const = default;
 };
 
 struct Dimensions
 {
-	double finishedWidth = 0.0;
-	double finishedHeight = 0.0;
-	double oversizeWidth = 0.0;
-	double oversizeHeight = 0.0;
-	double bonedetail = 0.0;
+	Length finishedWidth;
+	Length finishedHeight;
+	Length oversizeWidth;
+	Length oversizeHeight;
+	Length bonedetail;
 	ShakerParts shakerparts;
 	Panel panel;
-	double GetOversizedWidth() const { return finishedWidth + oversizeWidth - (bonedetail * 2.0); }
-	double GetOversizedHeight() const { return finishedHeight + oversizeHeight - (bonedetail * 2.0); }
-	double GetFinishedWidth() const { return finishedWidth; }
-	double GetFinishedHeight() const { return finishedHeight; }
+	Length GetOversizedWidth() const { return finishedWidth + oversizeWidth - (bonedetail * 2); }
+	Length GetOversizedHeight() const { return finishedHeight + oversizeHeight - (bonedetail * 2); }
+	Length GetFinishedWidth() const { return finishedWidth; }
+	Length GetFinishedHeight() const { return finishedHeight; }
+	bool operator==(const Dimensions&) const = default;
+};
+
+// What the reports need from a door's dimensions, worked out once for every
+// door right after it is validated (DoorStore::ComputeGeometry) and kept
+// with it, snapshot included.
+struct CutGeometry
+{
+	Length length[static_cast<int>(ShakerPart::SHAKERPARTCOUNT)] = {};		// CutLength, or the style's length formulas
+	Length partWidth[static_cast<int>(ShakerPart::SHAKERPARTCOUNT)] = {};	// PartWidth, or the style's width formulas
+	Length panelWidth;		// grain orientation applied
+	Length panelHeight;
+	Length panelCutWidth;	// across the door, rabbet included
+	Length panelCutHeight;
+	Length panelRabbet;
+	unsigned int panelCount = 1;
+	Length railStileLength;	// all rails and stiles of all copies
+	Length boneDetailLength;
+};
+
+// The texts Door::FormatTo writes; each is named after the getter that
+// returns it as a string
+enum class DoorText : uint8_t
+{
+	Name,				// the door's name as read
+	PanelLabel,			// the label as read
+	Label,				// "(Label: ...)"
+	Material,
+	Notes,
+	SpecialNotes,		// getNotes
+	Quantity,
+	Construction,
+	Type,
+	GrainOrientation,
+	FinishedSize,		// getFinishedSizeLabel: both sides in fractions
+	FinishedWidth,
+	FinishedHeight,
+	OversizeWidth,		// empty when there is no oversize
+	OversizeHeight,
+	CutWidth,
+	CutHeight,
+	BoneDetail,
+	PanelWidth,
+	PanelHeight,
+	LeftStileWidth,
+	RightStileWidth,
+	TopRailWidth,
+	BottomRailWidth,
+	MidRailWidth,
+	MidStileWidth,
+	LeftStileLength,
+	RightStileLength,
+	TopRailLength,
+	BottomRailLength,
+	MidRailLength,
+	MidStileLength
 };
 
 class Door
 {
-	char name[MAXTEXTSIZE] = {};
-	char label[MAXTEXTSIZE] = {};
-	char material[MAXTEXTSIZE] = {};
-	char notes[MAXTEXTSIZE] = {};
+	friend class DoorStore;
+
+	DoorString name;
+	DoorString label;
+	DoorString material;
+	DoorString notes;
 	Dimensions dimensions = {};
+	CutGeometry geometry = {};
+	uint32_t materialId = 0;	// ID in DoorList's material table
 	unsigned int quantity = 0;
 	Construction construction = {};
 	FaceType type = {};
 
 public:
-	char* getlabelPtr() { return label; }
-	std::string getsvgLabel() const { return label; }
-	bool ValidatePanel(double& outWidth, double& outHeight) const;
-	bool ValidateShakerParts(std::string& error) const;
-	std::string getNotes() const { return "SPECIAL NOTES: " + std::string(notes); }
-	bool hasNotes() const { return std::string(notes).length() > 0; }
+	// false if text was cut to DoorString::Capacity
+	bool SetLabel(std::string_view text) { return label.Assign(text); }
+	std::string getsvgLabel() const { return std::string(label.View()); }
+	uint64_t ContentHash() const;
+	// Doors with the same build differ at most in label and quantity; see DoorGroups
+	uint64_t BuildHash() const;
+	bool SameBuild(const Door& other) const;
+	const CutGeometry& Geometry() const { return geometry; }
+	const ConstructionStyle& Style() const { return StyleRegistry::Global()[construction]; }
+	const Dimensions& GetDimensions() const { return dimensions; }
+	std::string getNotes() const { return FormatString(DoorText::SpecialNotes); }
+	bool hasNotes() const { return !notes.empty(); }
 	unsigned int getQuantity() const { return quantity; }
-	double GetShakerPartWidth(ShakerPart part) const { return dimensions.shakerparts.width[static_cast<int>(part)]; }
-	double GetBoneDetail() const { return dimensions.bonedetail; }
-	double GetRail_Stile_Total_Length() const;
-	double GetBoneDetail_Total_Length() const;
+	double GetShakerPartWidth(ShakerPart part) const { return dimensions.shakerparts.width[static_cast<int>(part)].Inches(); }
+	double GetBoneDetail() const { return dimensions.bonedetail.Inches(); }
+	Length GetRail_Stile_Total_Length() const { return geometry.railStileLength; }
+	Length GetBoneDetail_Total_Length() const { return geometry.boneDetailLength; }
 	std::string GetPanelMaterial() const 	
 	{
-		return std::string(material);
-	}
-	double GetPanelWidth() const 
-	{ 
-		return dimensions.panel.GetPanelWidth(construction, dimensions.shakerparts, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight());
-	}
-	double GetPanelHeight() const 
-	{ 
-		return dimensions.panel.GetPanelHeight(construction, dimensions.shakerparts, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight());
+		return std::string(material.View());
 	}
-	double GetPanelRabbet() const { return dimensions.shakerparts.rabbet - RABBET_ALLOWANCE; }
+	std::string_view MaterialView() const { return material.View(); }
+	uint32_t GetMaterialId() const { return materialId; }
+	void SetMaterialId(uint32_t id) { materialId = id; }
+	Length GetPanelWidth() const { return geometry.panelWidth; }
+	Length GetPanelHeight() const { return geometry.panelHeight; }
+	Length GetPanelRabbet() const { return geometry.panelRabbet; }
+	Length GetCutLength(ShakerPart part) const { return geometry.length[static_cast<int>(part)]; }
 	bool hasMidRail() const { return dimensions.shakerparts.mid_rail_count > 0; }
 	bool hasMidStile() const { return dimensions.shakerparts.mid_stile_count > 0; }
-	bool hasBoneDetail() const { return dimensions.bonedetail != 0.0; }
+	bool hasBoneDetail() const { return dimensions.bonedetail != Length(); }
 	bool hasPanel() const 
 	{
-		if (construction != Construction::Shaker && construction != Construction::SmallShaker)
+		if (!Style().hasFrame)
 			return false;
 		return dimensions.panel.hasPanel;
 	}
-	std::string getMaterialString() const
-	{
-		return "Material: " + std::string(material);
-	}
-	std::string getNotesString() const
-	{
-		return "Notes: " + std::string(notes);
-	}
-	std::string getLabelString() const
-	{
-		return "(Label: " + std::string(label) + ")";
-	}
-	std::string getNameString() const
-	{
-		return std::string(name);
-	}
-	std::string getQuantityString() const
-	{
-		return "Quantity: " + std::to_string(quantity);
-	}
-	std::string getBoneDetailString(int denom) const
-	{
-		Fraction bonedetailfrac(dimensions.bonedetail, denom);
-		std::string bonedetailstr = "Bone Detail: " + bonedetailfrac.GetDecimalString();
-		return bonedetailstr;
-	}
-	std::string getPanelWidthString(int denom) const
-	{
-		double rabbet = 0.0;
-		if (construction == Construction::Shaker)
-			rabbet = GetPanelRabbet() * 2.0;
-		double panelWidth = dimensions.panel.GetPanelWidth(construction, dimensions.shakerparts, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight(), false) + rabbet;
-		Fraction panelwidthfrac(panelWidth, denom);
-		std::string panelwidthstr = "Panel Width: " + panelwidthfrac.GetDecimalString();
-		return panelwidthstr;
-	}
-	std::string getPanelHeightString(int denom) const
-	{
-		double rabbet = 0.0;
-		if (construction == Construction::Shaker)
-			rabbet = GetPanelRabbet() * 2.0;
-		double panelHeight = dimensions.panel.GetPanelHeight(construction, dimensions.shakerparts, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight(), false) + rabbet;
-		Fraction panelheightfrac(panelHeight, denom);
-		std::string panelheightstr = "Panel Height: " + panelheightfrac.GetDecimalString();
-		return panelheightstr;
-	}
-	std::string getConstructionString() const
-	{
-		switch (construction)
-		{
-		case Construction::Slab:
-			return "Slab";
-		case Construction::Shaker:
-			return "Shaker";
-		case Construction::SmallShaker:
-			return "Small Shaker";
-		default:
-			return "Undefined";
-		}
-	}
-	std::string getTypeString() const
-	{
-		switch (type)
-		{
-		case FaceType::Door:
-			return "Door";
-		case FaceType::Drawer:
-			return "Drawer";
-		case FaceType::Panel:
-			return "Panel";
-		default:
-			return "Undefined";
-		}
-	}
-	double getFinishedWidth() const { return dimensions.finishedWidth; }
-	double getFinishedHeight() const { return dimensions.finishedHeight; }
-	double getOversizeWidth() const { return dimensions.oversizeWidth; }
-	double getOversizeHeight() const { return dimensions.oversizeHeight; }
+	// Writes one of the door's texts to out, std::format_to style, and
+	// returns the iterator past it. Nothing is allocated; the get*String
+	// methods below are FormatString wrappers for callers that want a string.
+	template <typename Out>
+	Out FormatTo(Out out, DoorText text, int denom = 32) const;
 
-	std::string getFinishedSizeLabel(int denom) const
+	std::string FormatString(DoorText text, int denom = 32) const
 	{
-		Fraction finishedwidthfrac(dimensions.finishedWidth, denom);
-		Fraction finishedheightfrac(dimensions.finishedHeight, denom);
-		std::string finishedsize = finishedwidthfrac.GetFractionStringStrong() + " x " + finishedheightfrac.GetFractionStringStrong();
-		return finishedsize;
+		std::string s;
+		FormatTo(std::back_inserter(s), text, denom);
+		return s;
 	}
 
-	std::string getFinishedWidthString(int denom) const
-	{
-		Fraction finishedwidthfrac(dimensions.finishedWidth, denom);
-		std::string finishedwidth = "Finished Width: " + finishedwidthfrac.GetString();
-		return finishedwidth;
-	}
-	std::string getFinishedHeightString(int denom) const
-	{
-		Fraction finishedheightfrac(dimensions.finishedHeight, denom);
-		std::string finishedheight = "Finished Height: " + finishedheightfrac.GetString();
-		return finishedheight;
-	}
-	std::string getOversizeWidthString(int denom) const
-	{
-		Fraction oversizewidthfrac(dimensions.oversizeWidth, denom);
-		std::string sizeStr = "";
-		if (dimensions.oversizeWidth > 0.0)
-			sizeStr = "Oversize Width: " + oversizewidthfrac.GetDecimalString();
-		if (dimensions.oversizeWidth < 0.0)
-			sizeStr = "Undersize Width: " + oversizewidthfrac.GetDecimalString();
-		return sizeStr;
-	}
-	std::string getOversizeHeightString(int denom) const
-	{
-		Fraction oversizeheightfrac(dimensions.oversizeHeight, denom);
-		std::string sizeStr = "";
-		if (dimensions.oversizeHeight > 0.0)
-			sizeStr = "Oversize Height: " + oversizeheightfrac.GetDecimalString();
-		if (dimensions.oversizeHeight < 0.0)
-			sizeStr = "Undersize Height: " + oversizeheightfrac.GetDecimalString();
-		return sizeStr;
-	}
-	std::string getCutWidthString(int denom) const
-	{
-		Fraction width(dimensions.GetOversizedWidth(), denom);
-		std::string widthstr = "Cut Width: " + width.GetString();
-		return widthstr;
-	}
-	std::string getCutHeightString(int denom) const
-	{
-		Fraction height(dimensions.GetOversizedHeight(), denom);
-		std::string heightstr = "Cut Height: " + height.GetString();
-		return heightstr;
-	}
-	std::string getLeftStileWidthString(int denom) const
-	{ 
-		Fraction leftstilewidthfrac(dimensions.shakerparts.width[static_cast<int>(ShakerPart::LEFT_STILE)], denom);
-		std::string leftstilewidth = "Left Stile " + leftstilewidthfrac.GetDecimalString();
-		return leftstilewidth;
-	}
-	std::string getRightStileWidthString(int denom) const
-	{ 
-		Fraction rightstilewidthfrac(dimensions.shakerparts.width[static_cast<int>(ShakerPart::RIGHT_STILE)], denom);
-		std::string rightstilewidth = "Right Stile " + rightstilewidthfrac.GetDecimalString();
-		return rightstilewidth;
-	}
-	std::string getTopRailWidthString(int denom) const
-	{ 
-		Fraction toprailwidthfrac(dimensions.shakerparts.width[static_cast<int>(ShakerPart::TOP_RAIL)], denom);
-		std::string toprailwidth = "Top Rail " + toprailwidthfrac.GetDecimalString();
-		return toprailwidth;
-	}
-	std::string getBottomRailWidthString(int denom) const
-	{ 
-		Fraction bottomrailwidthfrac(dimensions.shakerparts.width[static_cast<int>(ShakerPart::BOTTOM_RAIL)], denom);
-		std::string bottomrailwidth = "Bottom Rail " + bottomrailwidthfrac.GetDecimalString();
-		return bottomrailwidth;
-	}
-	std::string getMidRailWidthString(int denom) const
-	{ 
-		if (dimensions.shakerparts.mid_rail_count > 0) 
-		{
-			Fraction midrailwidthfrac(dimensions.shakerparts.width[static_cast<int>(ShakerPart::MID_RAIL)], denom);
-			std::string midrailwidth = "Mid Rail " + midrailwidthfrac.GetDecimalString();
-			return midrailwidth;
-		} 
-		else 
-			return "Mid Rail N/A"; 
-	}
-	std::string getMidStileWidthString(int denom) const
-	{ 
-		if (dimensions.shakerparts.mid_stile_count > 0) 
-		{
-			Fraction midstilewidthfrac(dimensions.shakerparts.width[static_cast<int>(ShakerPart::MID_STILE)], denom);
-			std::string midstilewidth = "Mid Stile " + midstilewidthfrac.GetDecimalString();
-			return midstilewidth;
-		} 
-		else 
-			return "Mid Stile N/A"; 
-	}
-	std::string getGrainOrientationString() const
-	{
-		if (dimensions.panel.orientation == Orientation::VERTICAL)
-			return "Grain Orientation: Vertical";
-		else
-			return "Grain Orientation: Horizontal";
-	}
-	std::string getLeftStileLengthString(int denom) const
-	{ 
-		Fraction lengthfrac(dimensions.shakerparts.GetCutLength(construction, ShakerPart::LEFT_STILE, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight()), denom);
-		std::string length = "Length: " + lengthfrac.GetDecimalString();
-		return length;
-	}
-	std::string getRightStileLengthString(int denom) const
-	{ 
-		Fraction lengthfrac(dimensions.shakerparts.GetCutLength(construction, ShakerPart::RIGHT_STILE, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight()), denom);
-		std::string length = "Length: " + lengthfrac.GetDecimalString();
-		return length;
-	}
-	std::string getTopRailLengthString(int denom) const
-	{ 
-		Fraction lengthfrac(dimensions.shakerparts.GetCutLength(construction, ShakerPart::TOP_RAIL, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight()), denom);
-		std::string length = "Length: " + lengthfrac.GetDecimalString();
-		return length;
-	}
-	std::string getBottomRailLengthString(int denom) const
-	{ 
-		Fraction lengthfrac(dimensions.shakerparts.GetCutLength(construction, ShakerPart::BOTTOM_RAIL, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight()), denom);
-		std::string length = "Length: " + lengthfrac.GetDecimalString();
-		return length;
-	}
-	std::string getMidRailLengthString(int denom) const
-	{ 
-		if (dimensions.shakerparts.mid_rail_count > 0) 
-		{
-			Fraction lengthfrac(dimensions.shakerparts.GetCutLength(construction, ShakerPart::MID_RAIL, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight()), denom);
-			std::string length = "Length: " + lengthfrac.GetDecimalString();
-			return length;
-		} 
-		else 
-			return "Length: N/A"; 
-	}
-	std::string getMidStileLengthString(int denom) const
-	{ 
-		if (dimensions.shakerparts.mid_stile_count > 0) 
-		{
-			Fraction lengthfrac(dimensions.shakerparts.GetCutLength(construction, ShakerPart::MID_STILE, dimensions.GetOversizedWidth(), dimensions.GetOversizedHeight()), denom);
-			std::string length = "Length: " + lengthfrac.GetDecimalString();
-			return length;
-		} 
-		else 
-			return "Length: N/A"; 
-	}
+	std::string getMaterialString() const { return FormatString(DoorText::Material); }
+	std::string getNotesString() const { return FormatString(DoorText::Notes); }
+	std::string getLabelString() const { return FormatString(DoorText::Label); }
+	std::string getNameString() const { return FormatString(DoorText::Name); }
+	std::string getQuantityString() const { return FormatString(DoorText::Quantity); }
+	std::string getBoneDetailString(int denom) const { return FormatString(DoorText::BoneDetail, denom); }
+	std::string getPanelWidthString(int denom) const { return FormatString(DoorText::PanelWidth, denom); }
+	std::string getPanelHeightString(int denom) const { return FormatString(DoorText::PanelHeight, denom); }
+	std::string getConstructionString() const { return FormatString(DoorText::Construction); }
+	std::string getTypeString() const { return FormatString(DoorText::Type); }
+	double getFinishedWidth() const { return dimensions.finishedWidth.Inches(); }
+	double getFinishedHeight() const { return dimensions.finishedHeight.Inches(); }
+	double getOversizeWidth() const { return dimensions.oversizeWidth.Inches(); }
+	double getOversizeHeight() const { return dimensions.oversizeHeight.Inches(); }
+
+	std::string getFinishedSizeLabel(int denom) const { return FormatString(DoorText::FinishedSize, denom); }
+	std::string getFinishedWidthString(int denom) const { return FormatString(DoorText::FinishedWidth, denom); }
+	std::string getFinishedHeightString(int denom) const { return FormatString(DoorText::FinishedHeight, denom); }
+	std::string getOversizeWidthString(int denom) const { return FormatString(DoorText::OversizeWidth, denom); }
+	std::string getOversizeHeightString(int denom) const { return FormatString(DoorText::OversizeHeight, denom); }
+	std::string getCutWidthString(int denom) const { return FormatString(DoorText::CutWidth, denom); }
+	std::string getCutHeightString(int denom) const { return FormatString(DoorText::CutHeight, denom); }
+	std::string getLeftStileWidthString(int denom) const { return FormatString(DoorText::LeftStileWidth, denom); }
+	std::string getRightStileWidthString(int denom) const { return FormatString(DoorText::RightStileWidth, denom); }
+	std::string getTopRailWidthString(int denom) const { return FormatString(DoorText::TopRailWidth, denom); }
+	std::string getBottomRailWidthString(int denom) const { return FormatString(DoorText::BottomRailWidth, denom); }
+	std::string getMidRailWidthString(int denom) const { return FormatString(DoorText::MidRailWidth, denom); }
+	std::string getMidStileWidthString(int denom) const { return FormatString(DoorText::MidStileWidth, denom); }
+	std::string getGrainOrientationString() const { return FormatString(DoorText::GrainOrientation); }
+	std::string getLeftStileLengthString(int denom) const { return FormatString(DoorText::LeftStileLength, denom); }
+	std::string getRightStileLengthString(int denom) const { return FormatString(DoorText::RightStileLength, denom); }
+	std::string getTopRailLengthString(int denom) const { return FormatString(DoorText::TopRailLength, denom); }
+	std::string getBottomRailLengthString(int denom) const { return FormatString(DoorText::BottomRailLength, denom); }
+	std::string getMidRailLengthString(int denom) const { return FormatString(DoorText::MidRailLength, denom); }
+	std::string getMidStileLengthString(int denom) const { return FormatString(DoorText::MidStileLength, denom); }
 	int getMidStilecount() const
 	{
 		return dimensions.shakerparts.mid_stile_count;
@@ -552,35 +738,53 @@ public:
 	}
 	int getPanelcount() const
 	{
-		return dimensions.panel.GetPanelCount(construction, dimensions.shakerparts);
+		return geometry.panelCount;
 	}
 	std::string getPanelName() const
 	{
-		return name;
+		return std::string(name.View());
 	}
 	std::string getPanelLabel() const
 	{
-		return label;
+		return std::string(label.View());
 	}
+	std::string_view LabelView() const { return label.View(); }
 	int getPanelQuantity() const
 	{
 		return getPanelcount() * quantity;
 	}
 
 	Construction getConstruction() const { return construction; }
-	bool Create(const CsvRow& row, size_t row_index, std::vector<CsvError>& errors);
+	// Text fields longer than DoorString::Capacity are cut and noted in warnings
+	bool Create(const CsvRow& row, size_t row_index, std::vector<CsvError>& errors, std::vector<CsvError>& warnings);
 	void Print() const;
-	void AppendTigerStopCuts(std::vector<TigerStopItem>& cutlist) const;
-	void AppendShakerLabel(std::vector<Shaker_CSV_Label>& cutlist) const;
-	void AppendSlabLabel(std::vector<Slab_CSV_Label>& label_list) const;
+	// Cuts for copies of this door, which need not be its own quantity
+	void AppendTigerStopCuts(std::pmr::vector<TigerStopItem>& cutlist, unsigned int copies) const;
+	// The label every copy shares; false if the door gets none of this kind
+	bool GetShakerLabel(Shaker_CSV_Label& csv_label) const;
+	bool GetSlabLabel(Slab_CSV_Label& csv_label) const;
+	// One label per copy, numbered and stamped with this door's Cab#
+	template <typename Label>
+	void AppendLabelCopies(Label csv_label, std::pmr::vector<Label>& label_list) const;
 	double GetPerimeter() const
 	{
-		return dimensions.finishedWidth * 2.0 + dimensions.finishedHeight * 2;
+		return (dimensions.finishedWidth * 2 + dimensions.finishedHeight * 2).Inches();
 	}
 private:
+	// As ReadDouble, rounded to the nearest Length tick. Fails on lengths
+	// outside Length::InRange ("nan", "inf", "1e300").
+	inline bool ReadLength(const CsvRow& row, DoorColumn column, Length& out)
+	{
+		double inches = 0.0;
+		if (!ReadDouble(row, column, inches) || !Length::InRange(inches))
+			return false;
+		out = Length::FromInches(inches);
+		return true;
+	}
+
 	inline bool ReadFaceType(const CsvRow& row, FaceType& out)
 	{
-		const std::string& s = ToUpper(row["Type"]);
+		const std::string& s = ToUpper(row[DoorColumn::Type]);
 
 		if (s == "DOOR") { out = FaceType::Door; return true; }
 		if (s == "DRAWER") { out = FaceType::Drawer;   return true; }
@@ -591,18 +795,12 @@ private:
 
 	inline bool ReadConstruction(const CsvRow& row, Construction& out)
 	{
-		const std::string& s = ToUpper(row["Construction"]);
-
-		if (s == "SLAB") { out = Construction::Slab; return true; }
-		if (s == "SHAKER") { out = Construction::Shaker;   return true; }
-		if (s == "SMALL_SHAKER") { out = Construction::SmallShaker; return true; }
-
-		return false;
+		return StyleRegistry::Global().Find(ToUpper(row[DoorColumn::Construction]), out);
 	}
 
 	inline bool ReadOrientation(const CsvRow& row, Orientation& out)
 	{
-		const std::string& s = ToUpper(row["Grain Direction"]);
+		const std::string& s = ToUpper(row[DoorColumn::GrainDirection]);
 
 		if (s == "VERTICAL") { out = Orientation::VERTICAL; return true; }
 		if (s == "HORIZONTAL") { out = Orientation::HORIZONTAL;   return true; }
@@ -612,7 +810,7 @@ private:
 
 	inline bool ReadPanel(const CsvRow& row, bool& out)
 	{
-		const std::string& s = ToUpper(row["Panel"]);
+		const std::string& s = ToUpper(row[DoorColumn::Panel]);
 
 		if (s == "YES") { out = true; return true; }
 		else out = false;
@@ -621,57 +819,370 @@ private:
 	}
 };
 
-class DoorList
+template <typename Out>
+Out Door::FormatTo(Out out, DoorText text, int denom) const
 {
-	std::vector<Door> m_doors;
-	void ReadCsvTable(CsvTable doorsTable);
-	void makeUniqueLabels();
-	bool containsShaker() const {
-		for (const auto& door : m_doors)
+	auto put = [&out](std::string_view part) { out = std::copy(part.begin(), part.end(), out); };
+	auto decimal = [&](std::string_view prefix, Length value)
 		{
-			if (door.getConstruction() == Construction::Shaker)
-				return true;
-		}
-		return false;
-	}
-	bool containsSmallShaker() const
+			put(prefix);
+			out = Fraction(value, denom).DecimalTo(out);
+		};
+	auto string = [&](std::string_view prefix, Length value)
+		{
+			put(prefix);
+			out = Fraction(value, denom).StringTo(out);
+		};
+	auto oversize = [&](std::string_view over, std::string_view under, Length value)
+		{
+			if (value > Length())
+				decimal(over, value);
+			else if (value < Length())
+				decimal(under, value);
+		};
+	const ShakerParts& parts = dimensions.shakerparts;
+	auto partWidth = [&](ShakerPart part) { return parts.width[static_cast<int>(part)]; };
+
+	switch (text)
 	{
-		for (const auto& door : m_doors)
+	case DoorText::Name:				put(name); break;
+	case DoorText::PanelLabel:			put(label); break;
+	case DoorText::Label:				put("(Label: "); put(label); put(")"); break;
+	case DoorText::Material:			put("Material: "); put(material); break;
+	case DoorText::Notes:				put("Notes: "); put(notes); break;
+	case DoorText::SpecialNotes:		put("SPECIAL NOTES: "); put(notes); break;
+	case DoorText::Quantity:
+	{
+		char digits[16];
+		const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), quantity);
+		put("Quantity: ");
+		put(std::string_view(digits, end - digits));
+		break;
+	}
+	case DoorText::Construction:		put(Style().name); break;
+	case DoorText::Type:
+		switch (type)
 		{
-			if (door.getConstruction() == Construction::SmallShaker)
-				return true;
+		case FaceType::Door:	put("Door"); break;
+		case FaceType::Drawer:	put("Drawer"); break;
+		case FaceType::Panel:	put("Panel"); break;
+		default:				put("Undefined"); break;
 		}
-		return false;
+		break;
+	case DoorText::GrainOrientation:
+		put(dimensions.panel.orientation == Orientation::VERTICAL ? "Grain Orientation: Vertical" : "Grain Orientation: Horizontal");
+		break;
+	case DoorText::FinishedSize:
+		out = Fraction(dimensions.finishedWidth, denom).FractionStrongTo(out);
+		put(" x ");
+		out = Fraction(dimensions.finishedHeight, denom).FractionStrongTo(out);
+		break;
+	case DoorText::FinishedWidth:		string("Finished Width: ", dimensions.finishedWidth); break;
+	case DoorText::FinishedHeight:		string("Finished Height: ", dimensions.finishedHeight); break;
+	case DoorText::OversizeWidth:		oversize("Oversize Width: ", "Undersize Width: ", dimensions.oversizeWidth); break;
+	case DoorText::OversizeHeight:		oversize("Oversize Height: ", "Undersize Height: ", dimensions.oversizeHeight); break;
+	case DoorText::CutWidth:			string("Cut Width: ", dimensions.GetOversizedWidth()); break;
+	case DoorText::CutHeight:			string("Cut Height: ", dimensions.GetOversizedHeight()); break;
+	case DoorText::BoneDetail:			decimal("Bone Detail: ", dimensions.bonedetail); break;
+	case DoorText::PanelWidth:			decimal("Panel Width: ", geometry.panelCutWidth); break;
+	case DoorText::PanelHeight:			decimal("Panel Height: ", geometry.panelCutHeight); break;
+	case DoorText::LeftStileWidth:		decimal("Left Stile ", partWidth(ShakerPart::LEFT_STILE)); break;
+	case DoorText::RightStileWidth:		decimal("Right Stile ", partWidth(ShakerPart::RIGHT_STILE)); break;
+	case DoorText::TopRailWidth:		decimal("Top Rail ", partWidth(ShakerPart::TOP_RAIL)); break;
+	case DoorText::BottomRailWidth:		decimal("Bottom Rail ", partWidth(ShakerPart::BOTTOM_RAIL)); break;
+	case DoorText::MidRailWidth:
+		if (parts.mid_rail_count > 0)
+			decimal("Mid Rail ", partWidth(ShakerPart::MID_RAIL));
+		else
+			put("Mid Rail N/A");
+		break;
+	case DoorText::MidStileWidth:
+		if (parts.mid_stile_count > 0)
+			decimal("Mid Stile ", partWidth(ShakerPart::MID_STILE));
+		else
+			put("Mid Stile N/A");
+		break;
+	case DoorText::LeftStileLength:		decimal("Length: ", GetCutLength(ShakerPart::LEFT_STILE)); break;
+	case DoorText::RightStileLength:	decimal("Length: ", GetCutLength(ShakerPart::RIGHT_STILE)); break;
+	case DoorText::TopRailLength:		decimal("Length: ", GetCutLength(ShakerPart::TOP_RAIL)); break;
+	case DoorText::BottomRailLength:	decimal("Length: ", GetCutLength(ShakerPart::BOTTOM_RAIL)); break;
+	case DoorText::MidRailLength:
+		if (parts.mid_rail_count > 0)
+			decimal("Length: ", GetCutLength(ShakerPart::MID_RAIL));
+		else
+			put("Length: N/A");
+		break;
+	case DoorText::MidStileLength:
+		if (parts.mid_stile_count > 0)
+			decimal("Length: ", GetCutLength(ShakerPart::MID_STILE));
+		else
+			put("Length: N/A");
+		break;
+	}
+	return out;
+}
+
+// The checks ValidationRules runs on every door, in the order they run.
+// The first two remove a door from the list; the rest only warn, and run
+// only on doors that are kept. Which oversize checks apply to a door is
+// set by its style's OversizeRule.
+enum class DoorRule : uint8_t
+{
+	MinPanelSize,			// framed door with a panel under minPanelSize
+	RequiredPartWidth,		// a part width the style requires is not set
+	OversizeWidthAbove,		// Slab: oversize over slabOversizeMax
+	OversizeHeightAbove,
+	OversizeWidthBelow,		// Slab: under slabOversizeMin; Shaker: under shakerOversizeMin
+	OversizeHeightBelow,
+	OversizeMismatch,		// Slab: width and height oversize differ
+	OversizeWidthNotExact,	// Small Shaker: oversize other than smallShakerOversize
+	OversizeHeightNotExact,
+	COUNT
+};
+
+// Thresholds of the built-in rules, in inches
+struct ValidationLimits
+{
+	Length minPanelSize = Length::FromInches(1.0);
+	Length slabOversizeMax;
+	Length slabOversizeMin = Length::FromInches(-0.0625);
+	Length shakerOversizeMin;
+	Length smallShakerOversize;
+};
+
+struct DoorDiagnostic
+{
+	DoorRule rule;
+	bool removed;		// the door was dropped from the list
+	uint32_t door;		// the door's position among those validated
+	Length value;		// what was checked, where the rule checks one length
+	Length limit;
+	std::string text;	// as logged
+};
+
+// Runs every rule on every door in one pass, split across threads for big
+// lists. Checks compare lengths only; text is made for the doors that fail.
+class ValidationRules
+{
+public:
+	static ValidationRules& Global();
+
+	const ValidationLimits& Limits() const { return m_limits; }
+	void SetLimits(const ValidationLimits& limits) { m_limits = limits; }
+	// Changes whenever the limits do, so saved results can be checked
+	uint64_t Fingerprint() const;
+
+	// Reads "key = value" lines over the default limits: min_panel_size,
+	// slab_oversize_max, slab_oversize_min, shaker_oversize_min and
+	// small_shaker_oversize. Errors are logged as path:line; nothing
+	// changes unless the whole file is valid.
+	bool LoadFile(const std::string& path, std::ostream& log);
+
+	// Diagnostics in door order, and in rule order within a door. A door
+	// stops at the first rule that removes it. removed[i] is set for every
+	// door i that is dropped.
+	std::vector<DoorDiagnostic> Validate(std::span<const Door> doors, std::vector<uint8_t>& removed) const;
+
+private:
+	void ValidateRange(std::span<const Door> doors, size_t begin, size_t end,
+		std::vector<uint8_t>& removed, std::vector<DoorDiagnostic>& out) const;
+
+	static constexpr size_t MinChunkDoors = 16384;
+
+	ValidationLimits m_limits;
+};
+
+// Doors that are identical apart from their Cab# label and quantity: same
+// name, notes, material, construction, type and dimensions, and so the same
+// geometry, cuts per copy, labels and report tables. Work that depends only
+// on those is done once per group; labels and quantities are fanned out to
+// the members afterwards. Groups are numbered in the order of their first
+// door, and list their members in door order.
+class DoorGroups
+{
+public:
+	void Build(std::span<const Door> doors);
+
+	size_t Size() const { return m_start.empty() ? 0 : m_start.size() - 1; }
+	uint32_t GroupOf(size_t door) const { return m_groupOf[door]; }
+	std::span<const uint32_t> Members(size_t group) const
+	{
+		return std::span<const uint32_t>(m_members).subspan(m_start[group], m_start[group + 1] - m_start[group]);
 	}
-	bool containsSlab() const
+	uint32_t First(size_t group) const { return m_members[m_start[group]]; }
+	// Copies of every member together
+	unsigned int Quantity(size_t group) const { return m_quantity[group]; }
+
+private:
+	std::vector<uint32_t> m_groupOf;	// group of each door
+	std::vector<uint32_t> m_start;		// members of group g are m_members[m_start[g]..m_start[g + 1])
+	std::vector<uint32_t> m_members;
+	std::vector<unsigned int> m_quantity;
+};
+
+// The doors' numeric fields by column, with the rows grouped by style
+// (each group keeping the list's order). ComputeGeometry streams through
+// these hot columns only; the text it never reads stays behind in the Door
+// records. There is one row per DoorGroups group, since doors of a group
+// share their geometry. The style's kernel is picked once per style: code
+// styles run a loop templated on their rules, config styles one over their
+// formula table, so no door pays for a dispatch. It runs once per read, to
+// fill in the CutGeometry of every door.
+class DoorStore
+{
+public:
+	static constexpr size_t PartCount = static_cast<size_t>(ShakerPart::SHAKERPARTCOUNT);
+
+	void Build(std::span<const Door> doors, const DoorGroups& groups);
+	size_t Size() const { return group.size(); }
+
+	// Fills in doors[i].geometry; doors and groups must be the ones the
+	// store was built from
+	void ComputeGeometry(std::span<Door> doors, const DoorGroups& groups) const;
+
+	std::vector<uint32_t> group;		// DoorGroups group of each row
+	std::vector<uint32_t> rowOf;		// row of each DoorGroups group
+	std::vector<size_t> groupStart;		// rows of style c start at groupStart[c], one past the last style ends them
+	std::vector<int32_t> vertical;		// grain runs vertically
+	std::vector<int32_t> hasPanel;
+	std::vector<Length> oversizedWidth;
+	std::vector<Length> oversizedHeight;
+	std::vector<Length> finishedWidth;
+	std::vector<Length> finishedHeight;
+	std::vector<Length> boneDetail;
+	std::array<std::vector<Length>, PartCount> partWidth;
+	std::vector<Length> rabbet;
+	std::vector<Length> stickTolerance;
+	std::vector<Length> copeTolerance;
+	std::vector<int64_t> midRailCount;
+	std::vector<int64_t> midStileCount;
+
+private:
+	// What the kernels work out, a column per CutGeometry field with one
+	// entry per row. Each kernel loop fills one column from the input
+	// columns, row by row with nothing gathered or scattered, so the
+	// compiler can vectorize it.
+	struct GeometryColumns
 	{
-		for (const auto& door : m_doors)
+		std::array<std::vector<Length>, PartCount> length;
+		std::array<std::vector<Length>, PartCount> partWidth;
+		std::vector<Length> across;		// panel size across the door, before the grain
+		std::vector<Length> along;
+		std::vector<Length> panelWidth;
+		std::vector<Length> panelHeight;
+		std::vector<Length> panelCutWidth;
+		std::vector<Length> panelCutHeight;
+		std::vector<Length> panelRabbet;
+		std::vector<int64_t> panelCount;
+		std::vector<Length> railStileLength;
+		std::vector<Length> boneDetailLength;
+
+		void Resize(size_t rows);
+		CutGeometry Row(size_t row) const;
+	};
+
+	DoorFrame Frame(size_t row) const;
+	const Length* TermColumn(StyleLength length) const;
+	template <typename Rules>
+	void Evaluate(size_t begin, size_t end, GeometryColumns& out) const;
+	template <typename Rules, ShakerPart Part>
+	void EvaluatePart(size_t begin, size_t end, GeometryColumns& out) const;
+	void EvaluateTable(const ConstructionStyle& style, size_t begin, size_t end, GeometryColumns& out) const;
+	void EvaluateFormula(const StyleFormula& formula, size_t begin, size_t end, Length* out) const;
+	// Fills in what every kernel works out the same way, from the rows' cut
+	// lengths and their panel size across the door. Totals are for one
+	// copy; ComputeGeometry scales them by each door's quantity.
+	void FinishRows(size_t begin, size_t end, GeometryColumns& out,
+		bool hasFrame, bool countsMidParts, bool rabbetedPanel) const;
+};
+
+class DoorList
+{
+	std::vector<Door> m_doors;	// doors being read
+	MappedFile m_snapshot;
+	std::span<const Door> m_view;	// the finished list: m_doors or the mapped snapshot
+	StringTable m_materials;	// every material of m_view, by Door::GetMaterialId
+	DoorGroups m_groups;		// the doors of m_view by build
+	std::vector<DoorDiagnostic> m_diagnostics;	// from ValidationRules
+	bool m_consolidated = false;	// the door report shows each group once
+	unsigned int m_reportThreads = 1;	// drawing the door report; 0 is one per core
+	JobManifest m_manifest;
+	std::set<std::string> m_staleOutputs;
+	bool m_incremental = false;	// only m_staleOutputs are written
+	std::filesystem::path m_outputRoot;	// outputs go here; empty means the working directory
+	std::ostream& m_log;
+	std::pmr::memory_resource* m_memory;	// report text, tables and cut and label lists
+	void ReadCsvTable(const CsvTable& doorsTable);
+	void ReadCsvFile(const std::string& csvPath);
+	void ReadRow(const CsvRow& row, size_t row_index, std::vector<CsvError>& errors, std::vector<CsvError>& warnings, unsigned int& skippedCount);
+	void FinishReading(const std::vector<CsvError>& errors, const std::vector<CsvError>& warnings, unsigned int skippedCount);
+	void ReportMissingColumns(const std::vector<std::string_view>& missing) const;
+	void makeUniqueLabels();
+	bool LoadSnapshot(const std::string& csvPath, const Snapshot::SourceStamp& source);
+	void WriteSnapshot(const std::string& csvPath, const Snapshot::SourceStamp& source) const;
+	JobManifest BuildManifest(const std::string& jobname, bool& usable) const;
+	bool ShouldWrite(const std::filesystem::path& output) const;
+	std::pmr::vector<TigerStopItem> TigerStopCutList() const;
+	template <typename Label>
+	std::pmr::vector<Label> LabelCopies(bool (Door::*getLabel)(Label&) const) const;
+	std::filesystem::path OutputPath(const std::filesystem::path& output) const { return m_outputRoot / output; }
+	bool containsFramed() const
+	{
+		for (const auto& door : m_view)
 		{
-			if (door.getConstruction() == Construction::Slab)
+			if (door.Style().hasFrame)
 				return true;
 		}
 		return false;
 	}
 public:
-	DoorList(CsvTable doorsTable);
+	// Progress and warnings go to log, so concurrent jobs keep theirs apart.
+	// The short-lived text of reading and of every Write* call comes from
+	// memory, typically a JobArena's, which must outlive the list.
+	DoorList(const CsvTable& doorsTable, std::ostream& log = std::cout,
+		std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+	// Re-runs on an unchanged CSV map the snapshot written next to it
+	// instead of parsing and validating the file again.
+	explicit DoorList(const std::string& csvPath, std::ostream& log = std::cout,
+		std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+	// Every output path below is taken relative to root
+	void SetOutputRoot(const std::filesystem::path& root) { m_outputRoot = root; }
+	// Door report layout: one block per door, or one per group of identical
+	// doors listing every label. Set before PlanOutputs.
+	void SetConsolidatedReport(bool consolidated) { m_consolidated = consolidated; }
+	// Threads drawing the door report's blocks, 0 for one per core. The
+	// report is the same whatever the count.
+	void SetReportThreads(unsigned int threads) { m_reportThreads = threads; }
+	// Compares this run with the manifest the last one left in the working
+	// directory, so that the Write* calls below skip every output file no
+	// changed door goes into. SaveOutputManifest records this run for the next.
+	void PlanOutputs(const std::string& jobname);
+	void SaveOutputManifest(const std::string& jobname) const;
 	void WriteHTMLReport(const char* folder) const;
 	void WriteTigerStopCsvs(const std::string& jobname) const;
 	void WriteShakerLabelCsv(const std::string& jobname) const;
 	void WriteSlabLabelCsv(const std::string& jobname) const;
 	void WritePanelCsvs(const std::string& jobname) const;
 	void Print();
-	void OverSize_SanityCheck();
+	// Logs the warnings of the validation pass; doors it removed were
+	// logged while reading
+	void OverSize_SanityCheck() const;
+	// Every rule a door failed. Warnings give the door's position in this
+	// list; removals its position among the doors read.
+	const std::vector<DoorDiagnostic>& Diagnostics() const { return m_diagnostics; }
+	size_t GetDoorCount() const { return m_view.size(); }
+	// True if any door has rails and stiles to cut
 	bool HasShaker()
 	{
-		if (containsShaker() || containsSmallShaker())
-			return true;
-		return false;
+		return containsFramed();
 	}
 	double GetTotalPerimeter() const
 	
 	{
 		double perimeter = 0.0;
-		for (const auto& door : m_doors)
+		for (const auto& door : m_view)
 		{
 			perimeter += door.GetPerimeter();
 		}
@@ -679,26 +1190,20 @@ public:
 	}
 
 	double GetTotalLinearFootage() const
-
 	{
-		double length = 0.0;
-		for (const auto& door : m_doors)
-		{
+		Length length;
+		for (const auto& door : m_view)
 			length += door.GetRail_Stile_Total_Length();
-		}
-		double footage = length / 12.0;
+		double footage = length.Inches() / 12.0;
 		return footage;
 	}
 
 	double GetTotalLinearFootageBoneDetail() const
-
 	{
-		double length = 0.0;
-		for (const auto& door : m_doors)
-		{
+		Length length;
+		for (const auto& door : m_view)
 			length += door.GetBoneDetail_Total_Length();
-		}
-		double footage = length / 12.0;
+		double footage = length.Inches() / 12.0;
 		return footage;
 	}
 
@@ -728,26 +1233,18 @@ inline StockGroup GetStockGroup(ShakerPart part)
 
 inline std::string FormatTrimmed(double value)
 {
-	// 1. Round to 2 decimal places
-	std::string s = std::format("{:.4f}", value);
+	return Fraction::FormatDecimal(value);
+}
 
-	// 2. Remove trailing zeros
-	if (s.find('.') != std::string::npos)
-	{
-		s.erase(s.find_last_not_of('0') + 1, std::string::npos);
-		// 3. Remove trailing decimal point if it's the last character
-		if (s.back() == '.')
-		{
-			s.pop_back();
-		}
-	}
-	return s;
+inline std::string FormatTrimmed(Length value)
+{
+	return Fraction::FormatDecimal(value);
 }
 
 inline std::string MakeTigerStopFilename(StockGroup group, double width, std::string jobname)
 {
 	std::string g = (group == StockGroup::Rail) ? "Rails" : "Stiles";
 	std::string s_width = FormatTrimmed(width);
-	std::string formatted_str = std::format("{} {} {}inch", jobname, g, s_width);
+	std::string formatted_str = jobname + " " + g + " " + s_width + "inch";
 	return formatted_str;
 }
\ No newline at end of file
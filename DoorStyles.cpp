@@ -0,0 +1,601 @@
+#include "Door.h"
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cctype>
+#include "CsvUtils.h"
+
+StyleRegistry::StyleRegistry()
+{
+    // In Construction order
+    ConstructionStyle slab;
+    slab.keyword = "SLAB";
+    slab.name = "Slab";
+    slab.drawing = Html::Svg::DoorStyle::Slab;
+    slab.panelList = PanelList::Slab;
+    slab.labels = LabelList::Slab;
+    slab.oversize = OversizeRule::Slab;
+    Add(ConstructionStyle::FromRules<SlabRules>(slab));
+
+    ConstructionStyle shaker;
+    shaker.keyword = "SHAKER";
+    shaker.name = "Shaker";
+    for (bool& required : shaker.requiredWidth)
+        required = true;
+    shaker.drawing = Html::Svg::DoorStyle::Shaker;
+    shaker.panelList = PanelList::Shaker;
+    shaker.labels = LabelList::Shaker;
+    shaker.stock = StockGrouping::ByPart;
+    shaker.oversize = OversizeRule::Shaker;
+    Add(ConstructionStyle::FromRules<ShakerRules>(shaker));
+
+    ConstructionStyle smallShaker;
+    smallShaker.keyword = "SMALL_SHAKER";
+    smallShaker.name = "Small Shaker";
+    for (ShakerPart part : { ShakerPart::TOP_RAIL, ShakerPart::BOTTOM_RAIL, ShakerPart::LEFT_STILE, ShakerPart::RIGHT_STILE })
+        smallShaker.requiredWidth[static_cast<size_t>(part)] = true;
+    smallShaker.drawing = Html::Svg::DoorStyle::ShakerMitered;
+    smallShaker.panelList = PanelList::SmallShaker;
+    smallShaker.labels = LabelList::Slab;
+    smallShaker.stock = StockGrouping::SmallShakerRail;
+    smallShaker.oversize = OversizeRule::SmallShaker;
+    Add(ConstructionStyle::FromRules<SmallShakerRules>(smallShaker));
+}
+
+StyleRegistry& StyleRegistry::Global()
+{
+    static StyleRegistry registry;
+    return registry;
+}
+
+bool StyleRegistry::Add(ConstructionStyle style)
+{
+    uint32_t id = 0;
+    if (m_keywords.Find(style.keyword, id))
+        return false;
+
+    m_keywords.Intern(style.keyword);
+    m_styles.push_back(std::move(style));
+    return true;
+}
+
+bool StyleRegistry::Find(std::string_view keyword, Construction& out) const
+{
+    uint32_t id = 0;
+    if (!m_keywords.Find(keyword, id))
+        return false;
+    out = static_cast<Construction>(id);
+    return true;
+}
+
+uint64_t StyleRegistry::Fingerprint() const
+{
+    uint64_t hash = Snapshot::HashSeed;
+    auto add = [&](const auto& value)
+        {
+            hash = Snapshot::HashBytes({ reinterpret_cast<const char*>(&value), sizeof(value) }, hash);
+        };
+    auto addText = [&](const std::string& text)
+        {
+            hash = Snapshot::HashBytes(text, hash);
+            add('\0');
+        };
+    auto addFormula = [&](const StyleFormula& formula)
+        {
+            for (int32_t c : formula.coeff)
+                add(c);
+            add(formula.constant.Ticks());
+            add(formula.divisor);
+        };
+
+    for (const ConstructionStyle& style : m_styles)
+    {
+        addText(style.keyword);
+        addText(style.name);
+        add(style.kernel);
+        add(style.hasFrame);
+        add(style.countsMidParts);
+        add(style.rabbetedPanel);
+        for (bool required : style.requiredWidth)
+            add(required);
+        add(style.drawing);
+        add(style.panelList);
+        add(style.labels);
+        add(style.stock);
+        add(style.oversize);
+        for (const StyleFormula& formula : style.width)
+            addFormula(formula);
+        for (const StyleFormula& formula : style.length)
+            addFormula(formula);
+        addFormula(style.panelWidth);
+        addFormula(style.panelHeight);
+    }
+    return hash;
+}
+
+namespace
+{
+    struct NamedValue
+    {
+        std::string_view name;
+        int value;
+    };
+
+    constexpr NamedValue LengthNames[] =
+    {
+        { "door_width", static_cast<int>(StyleLength::DoorWidth) },
+        { "door_height", static_cast<int>(StyleLength::DoorHeight) },
+        { "top_rail", static_cast<int>(StyleLength::TopRail) },
+        { "bottom_rail", static_cast<int>(StyleLength::BottomRail) },
+        { "left_stile", static_cast<int>(StyleLength::LeftStile) },
+        { "right_stile", static_cast<int>(StyleLength::RightStile) },
+        { "mid_rail", static_cast<int>(StyleLength::MidRail) },
+        { "mid_stile", static_cast<int>(StyleLength::MidStile) },
+        { "rabbet", static_cast<int>(StyleLength::Rabbet) },
+        { "stick", static_cast<int>(StyleLength::Stick) },
+        { "cope", static_cast<int>(StyleLength::Cope) },
+        { "allowance", static_cast<int>(StyleLength::Allowance) }
+    };
+
+    // Part names, in ShakerPart order
+    constexpr std::string_view PartNames[] =
+    {
+        "top_rail", "bottom_rail", "left_stile", "right_stile", "mid_rail", "mid_stile"
+    };
+
+    constexpr NamedValue CountNames[] =
+    {
+        { "mid_rails", static_cast<int>(StyleCount::MidRails) },
+        { "mid_stiles", static_cast<int>(StyleCount::MidStiles) }
+    };
+
+    constexpr NamedValue DivisorNames[] =
+    {
+        { "panels_across", static_cast<int>(StyleDivisor::PanelsAcross) },
+        { "panels_down", static_cast<int>(StyleDivisor::PanelsDown) }
+    };
+
+    constexpr NamedValue DrawingNames[] =
+    {
+        { "slab", static_cast<int>(Html::Svg::DoorStyle::Slab) },
+        { "shaker", static_cast<int>(Html::Svg::DoorStyle::Shaker) },
+        { "mitered", static_cast<int>(Html::Svg::DoorStyle::ShakerMitered) }
+    };
+
+    constexpr NamedValue PanelListNames[] =
+    {
+        { "shaker", static_cast<int>(PanelList::Shaker) },
+        { "small_shaker", static_cast<int>(PanelList::SmallShaker) },
+        { "slab", static_cast<int>(PanelList::Slab) },
+        { "none", static_cast<int>(PanelList::None) }
+    };
+
+    constexpr NamedValue LabelListNames[] =
+    {
+        { "shaker", static_cast<int>(LabelList::Shaker) },
+        { "slab", static_cast<int>(LabelList::Slab) }
+    };
+
+    constexpr NamedValue StockNames[] =
+    {
+        { "by_part", static_cast<int>(StockGrouping::ByPart) },
+        { "small_shaker", static_cast<int>(StockGrouping::SmallShakerRail) }
+    };
+
+    constexpr NamedValue OversizeNames[] =
+    {
+        { "slab", static_cast<int>(OversizeRule::Slab) },
+        { "shaker", static_cast<int>(OversizeRule::Shaker) },
+        { "small_shaker", static_cast<int>(OversizeRule::SmallShaker) }
+    };
+
+    constexpr NamedValue YesNoNames[] =
+    {
+        { "yes", 1 },
+        { "no", 0 }
+    };
+
+    template <size_t N>
+    bool Lookup(const NamedValue (&names)[N], std::string_view name, int& value)
+    {
+        for (const NamedValue& named : names)
+        {
+            if (named.name == name)
+            {
+                value = named.value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename Enum, size_t N>
+    bool LookupEnum(const NamedValue (&names)[N], std::string_view name, Enum& out)
+    {
+        int value = 0;
+        if (!Lookup(names, name, value))
+            return false;
+        out = static_cast<Enum>(value);
+        return true;
+    }
+
+    int PartIndex(std::string_view name)
+    {
+        for (size_t p = 0; p < std::size(PartNames); ++p)
+        {
+            if (PartNames[p] == name)
+                return static_cast<int>(p);
+        }
+        return -1;
+    }
+
+    // Splits formula text into names, numbers and single-character operators
+    bool Tokenize(std::string_view text, std::vector<std::string_view>& tokens)
+    {
+        size_t i = 0;
+        while (i < text.size())
+        {
+            const char c = text[i];
+            if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                ++i;
+                continue;
+            }
+
+            size_t end = i + 1;
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+            {
+                while (end < text.size() && (std::isalnum(static_cast<unsigned char>(text[end])) || text[end] == '_'))
+                    ++end;
+            }
+            else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+            {
+                while (end < text.size() && (std::isdigit(static_cast<unsigned char>(text[end])) || text[end] == '.'))
+                    ++end;
+            }
+            else if (std::string_view("+-*/()").find(c) == std::string_view::npos)
+                return false;
+
+            tokens.push_back(text.substr(i, end - i));
+            i = end;
+        }
+        return true;
+    }
+
+    // Formula grammar:
+    //   formula := sum [ "/" divisor ]  |  "(" sum ")" "/" divisor
+    //   sum     := [ "-" ] product { ( "+" | "-" ) product }
+    //   product := factor { "*" factor }
+    // A product holds at most one length and one count; with a length its
+    // numbers must be whole, without one it is a constant in inches.
+    class FormulaParser
+    {
+    public:
+        FormulaParser(const std::vector<std::string_view>& tokens, StyleFormula& formula, std::string& error)
+            : m_tokens(tokens), m_formula(formula), m_error(error)
+        {}
+
+        bool Parse()
+        {
+            m_formula = StyleFormula();
+            const bool parenthesized = Peek() == "(";
+            if (parenthesized)
+                ++m_next;
+
+            if (!ParseSum())
+                return false;
+
+            if (parenthesized && !Expect(")"))
+                return false;
+
+            if (Peek() == "/")
+            {
+                ++m_next;
+                if (!LookupEnum(DivisorNames, Take(), m_formula.divisor))
+                    return Fail("expected panels_across or panels_down after /");
+            }
+            else if (parenthesized)
+                return Fail("a parenthesized formula must be divided by panels_across or panels_down");
+
+            if (m_next != m_tokens.size())
+                return Fail("unexpected '" + std::string(Peek()) + "'");
+            return true;
+        }
+
+    private:
+        std::string_view Peek() const { return m_next < m_tokens.size() ? m_tokens[m_next] : std::string_view(); }
+        std::string_view Take() { return m_next < m_tokens.size() ? m_tokens[m_next++] : std::string_view(); }
+
+        bool Fail(const std::string& message)
+        {
+            m_error = message;
+            return false;
+        }
+
+        bool Expect(std::string_view token)
+        {
+            if (Take() == token)
+                return true;
+            return Fail("expected '" + std::string(token) + "'");
+        }
+
+        bool ParseSum()
+        {
+            int sign = 1;
+            if (Peek() == "-")
+            {
+                ++m_next;
+                sign = -1;
+            }
+            if (!ParseProduct(sign))
+                return false;
+
+            while (Peek() == "+" || Peek() == "-")
+            {
+                sign = Take() == "+" ? 1 : -1;
+                if (!ParseProduct(sign))
+                    return false;
+            }
+            return true;
+        }
+
+        bool ParseProduct(int sign)
+        {
+            int64_t factor = sign;
+            double inches = 1.0;
+            bool whole = true;
+            int length = -1;
+            int count = static_cast<int>(StyleCount::One);
+
+            for (;;)
+            {
+                const std::string_view token = Take();
+                if (token.empty())
+                    return Fail("formula ends early");
+
+                int value = 0;
+                if (Lookup(LengthNames, token, value))
+                {
+                    if (length >= 0)
+                        return Fail("two lengths multiplied");
+                    length = value;
+                }
+                else if (Lookup(CountNames, token, value))
+                {
+                    if (count != static_cast<int>(StyleCount::One))
+                        return Fail("two counts multiplied");
+                    count = value;
+                }
+                else if (ParseInt(token, value))
+                    factor *= value;
+                else
+                {
+                    double number = 0.0;
+                    if (!ParseInches(token, number))
+                        return Fail("unknown name '" + std::string(token) + "'");
+                    if (!Length::InRange(number))
+                        return Fail("length '" + std::string(token) + "' out of range");
+                    inches *= number;
+                    whole = false;
+                }
+
+                if (Peek() != "*")
+                    break;
+                ++m_next;
+            }
+
+            if (length < 0)
+            {
+                if (count != static_cast<int>(StyleCount::One))
+                    return Fail("a count must multiply a length");
+                const double constant = static_cast<double>(factor) * inches;
+                if (!Length::InRange(constant))
+                    return Fail("constant out of range");
+                m_formula.constant += Length::FromInches(constant);
+                return true;
+            }
+            if (!whole)
+                return Fail("lengths can only be multiplied by whole numbers");
+
+            m_formula.coeff[StyleFormula::Term(static_cast<StyleLength>(length), static_cast<StyleCount>(count))] += static_cast<int32_t>(factor);
+            return true;
+        }
+
+        const std::vector<std::string_view>& m_tokens;
+        size_t m_next = 0;
+        StyleFormula& m_formula;
+        std::string& m_error;
+    };
+
+    // A config style before anything is set: no frame, nominal part widths,
+    // no cut lengths and a panel the size of the door
+    ConstructionStyle NewTableStyle(const std::string& keyword)
+    {
+        ConstructionStyle style;
+        style.keyword = keyword;
+        style.name = keyword;
+        style.kernel = StyleKernel::Table;
+        for (size_t p = 0; p < ConstructionStyle::PartCount; ++p)
+            style.width[p] = StyleFormula::Of(static_cast<StyleLength>(static_cast<size_t>(StyleLength::TopRail) + p));
+        style.panelWidth = StyleFormula::Of(StyleLength::DoorWidth);
+        style.panelHeight = StyleFormula::Of(StyleLength::DoorHeight);
+        return style;
+    }
+
+    bool SetStyleKey(ConstructionStyle& style, std::string_view key, std::string_view value, std::string& error)
+    {
+        auto setEnum = [&](const auto& names, auto& out)
+            {
+                if (LookupEnum(names, value, out))
+                    return true;
+                error = "unknown " + std::string(key) + " '" + std::string(value) + "'";
+                return false;
+            };
+        auto setFormula = [&](StyleFormula& out)
+            {
+                std::vector<std::string_view> tokens;
+                if (!Tokenize(value, tokens))
+                {
+                    error = "unexpected character in formula";
+                    return false;
+                }
+                return FormulaParser(tokens, out, error).Parse();
+            };
+
+        int flag = 0;
+        if (key == "name")
+        {
+            style.name = std::string(value);
+            return true;
+        }
+        if (key == "frame" || key == "mid_parts_in_total" || key == "rabbeted_panel")
+        {
+            if (!setEnum(YesNoNames, flag))
+                return false;
+            bool& out = key == "frame" ? style.hasFrame : key == "mid_parts_in_total" ? style.countsMidParts : style.rabbetedPanel;
+            out = flag != 0;
+            return true;
+        }
+        if (key == "drawing")
+            return setEnum(DrawingNames, style.drawing);
+        if (key == "panels")
+            return setEnum(PanelListNames, style.panelList);
+        if (key == "labels")
+            return setEnum(LabelListNames, style.labels);
+        if (key == "tigerstop")
+            return setEnum(StockNames, style.stock);
+        if (key == "oversize")
+            return setEnum(OversizeNames, style.oversize);
+        if (key == "required")
+        {
+            std::fill(std::begin(style.requiredWidth), std::end(style.requiredWidth), false);
+            std::vector<std::string_view> parts;
+            if (!Tokenize(value, parts))
+            {
+                error = "unexpected character in part list";
+                return false;
+            }
+            for (std::string_view part : parts)
+            {
+                const int p = PartIndex(part);
+                if (p < 0)
+                {
+                    error = "unknown part '" + std::string(part) + "'";
+                    return false;
+                }
+                style.requiredWidth[p] = true;
+            }
+            return true;
+        }
+        if (key == "panel_width")
+            return setFormula(style.panelWidth);
+        if (key == "panel_height")
+            return setFormula(style.panelHeight);
+
+        const size_t dot = key.find('.');
+        if (dot != std::string_view::npos)
+        {
+            const std::string_view kind = key.substr(0, dot);
+            const int p = PartIndex(key.substr(dot + 1));
+            if (p >= 0 && kind == "width")
+                return setFormula(style.width[p]);
+            if (p >= 0 && kind == "length")
+                return setFormula(style.length[p]);
+        }
+
+        error = "unknown key '" + std::string(key) + "'";
+        return false;
+    }
+}
+
+// Style config file: one section per style, headed by the Construction
+// column value that selects it, then key = value lines. Blank lines and
+// lines starting with # are skipped. For example:
+//   [FIVE_PIECE]
+//   name = Five Piece
+//   frame = yes
+//   mid_parts_in_total = yes
+//   drawing = shaker
+//   panels = shaker
+//   labels = shaker
+//   tigerstop = by_part
+//   oversize = shaker
+//   required = top_rail bottom_rail left_stile right_stile
+//   length.top_rail = door_width - left_stile - right_stile + 2*stick + 2*cope
+//   panel_width = (door_width - left_stile - right_stile + 2*stick - allowance) / panels_across
+// Formulas name door_width, door_height, the nominal part widths (top_rail,
+// bottom_rail, left_stile, right_stile, mid_rail, mid_stile), rabbet, stick,
+// cope and allowance; a term can be multiplied by mid_rails or mid_stiles.
+// Unset keys keep the defaults of NewTableStyle.
+bool StyleRegistry::LoadFile(const std::string& path, std::ostream& log)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        log << "Cannot read door styles " << path << "\n";
+        return false;
+    }
+
+    std::vector<ConstructionStyle> styles;
+    bool ok = true;
+    size_t lineNumber = 0;
+    std::string line;
+
+    auto fail = [&](const std::string& message)
+        {
+            log << path << ":" << lineNumber << ": " << message << "\n";
+            ok = false;
+        };
+
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        const std::string entry = Trim(line);
+        if (entry.empty() || entry[0] == '#')
+            continue;
+
+        if (entry.front() == '[')
+        {
+            if (entry.back() != ']' || entry.size() < 3)
+            {
+                fail("expected [STYLE]");
+                continue;
+            }
+            const std::string keyword = ToUpper(Trim(std::string_view(entry).substr(1, entry.size() - 2)));
+            Construction existing{};
+            bool duplicate = Find(keyword, existing);
+            for (const ConstructionStyle& style : styles)
+                duplicate = duplicate || style.keyword == keyword;
+            if (duplicate)
+                fail("style " + keyword + " is already defined");
+            styles.push_back(NewTableStyle(keyword));
+            continue;
+        }
+
+        const size_t equals = entry.find('=');
+        if (equals == std::string::npos)
+        {
+            fail("expected key = value");
+            continue;
+        }
+        if (styles.empty())
+        {
+            fail("key outside a [STYLE] section");
+            continue;
+        }
+
+        std::string error;
+        const std::string_view text = entry;
+        if (!SetStyleKey(styles.back(), TrimView(text.substr(0, equals)), TrimView(text.substr(equals + 1)), error))
+            fail(error);
+    }
+
+    if (!ok)
+        return false;
+
+    for (ConstructionStyle& style : styles)
+        Add(std::move(style));
+    log << "Loaded " << styles.size() << " door style(s) from " << path << "\n";
+    return true;
+}
@@ -0,0 +1,341 @@
+#include "Door.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include "CsvUtils.h"
+
+namespace
+{
+    // What a rule found; value and limit are only read when it fails
+    struct RuleCheck
+    {
+        bool fails = false;
+        Length value;
+        Length limit;
+    };
+
+    struct RuleDef
+    {
+        DoorRule rule;
+        bool removes;
+        RuleCheck (*check)(const Door& door, const ValidationLimits& limits);
+        // The rule's part of the log entry; only called for doors that fail
+        void (*describe)(const Door& door, const RuleCheck& check, std::ostream& out);
+    };
+
+    RuleCheck Fails(bool fails, Length value, Length limit)
+    {
+        return { fails, value, limit };
+    }
+
+    // The first part width the door's style requires that is not set
+    bool FindMissingPart(const Door& door, ShakerPart& part)
+    {
+        const ConstructionStyle& style = door.Style();
+        const ShakerParts& parts = door.GetDimensions().shakerparts;
+        for (size_t i = 0; i < std::size(style.requiredWidth); ++i)
+        {
+            if (style.requiredWidth[i] && parts.width[i] <= Length())
+            {
+                part = static_cast<ShakerPart>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void DescribeOversize(const Door& door, const char* axis, const RuleCheck& check, const char* relation, std::ostream& out)
+    {
+        out << "Oversize " << axis << ": " << check.value.Inches() << " is " << relation << " "
+            << FormatTrimmed(check.limit) << " for " << door.getConstructionString() << " type!";
+    }
+
+    // Below the lower limit. Shaker doors checked against the default limit
+    // of zero keep the wording the warning has always had.
+    void DescribeUndersize(const Door& door, const char* axis, const RuleCheck& check, std::ostream& out)
+    {
+        if (door.Style().oversize == OversizeRule::Shaker && check.limit == Length())
+            out << "Oversize " << axis << ": " << check.value.Inches() << " is negative on " << door.getConstructionString() << " type!";
+        else
+            DescribeOversize(door, axis, check, "less than", out);
+    }
+
+    constexpr RuleDef Rules[] =
+    {
+        {
+            DoorRule::MinPanelSize, true,
+            [](const Door& door, const ValidationLimits& limits)
+            {
+                const Length smaller = std::min(door.GetPanelWidth(), door.GetPanelHeight());
+                return Fails(door.Style().hasFrame && smaller < limits.minPanelSize, smaller, limits.minPanelSize);
+            },
+            [](const Door& door, const RuleCheck&, std::ostream& out)
+            {
+                out << "Below minimum panel size. " << door.GetPanelWidth().Inches() << " x " << door.GetPanelHeight().Inches();
+            }
+        },
+        {
+            DoorRule::RequiredPartWidth, true,
+            [](const Door& door, const ValidationLimits&)
+            {
+                ShakerPart part{};
+                if (!FindMissingPart(door, part))
+                    return RuleCheck();
+                return Fails(true, door.GetDimensions().shakerparts.width[static_cast<int>(part)], Length());
+            },
+            [](const Door& door, const RuleCheck&, std::ostream& out)
+            {
+                ShakerPart part{};
+                FindMissingPart(door, part);
+                out << door.GetDimensions().shakerparts.GetPartString(part) << " Width undefined";
+            }
+        },
+        {
+            DoorRule::OversizeWidthAbove, false,
+            [](const Door& door, const ValidationLimits& limits)
+            {
+                const Length oversize = door.GetDimensions().oversizeWidth;
+                return Fails(door.Style().oversize == OversizeRule::Slab && oversize > limits.slabOversizeMax, oversize, limits.slabOversizeMax);
+            },
+            [](const Door& door, const RuleCheck& check, std::ostream& out) { DescribeOversize(door, "Width", check, "greater than", out); }
+        },
+        {
+            DoorRule::OversizeHeightAbove, false,
+            [](const Door& door, const ValidationLimits& limits)
+            {
+                const Length oversize = door.GetDimensions().oversizeHeight;
+                return Fails(door.Style().oversize == OversizeRule::Slab && oversize > limits.slabOversizeMax, oversize, limits.slabOversizeMax);
+            },
+            [](const Door& door, const RuleCheck& check, std::ostream& out) { DescribeOversize(door, "Height", check, "greater than", out); }
+        },
+        {
+            DoorRule::OversizeWidthBelow, false,
+            [](const Door& door, const ValidationLimits& limits)
+            {
+                const OversizeRule rule = door.Style().oversize;
+                const Length limit = rule == OversizeRule::Slab ? limits.slabOversizeMin : limits.shakerOversizeMin;
+                const Length oversize = door.GetDimensions().oversizeWidth;
+                return Fails(rule != OversizeRule::SmallShaker && oversize < limit, oversize, limit);
+            },
+            [](const Door& door, const RuleCheck& check, std::ostream& out) { DescribeUndersize(door, "Width", check, out); }
+        },
+        {
+            DoorRule::OversizeHeightBelow, false,
+            [](const Door& door, const ValidationLimits& limits)
+            {
+                const OversizeRule rule = door.Style().oversize;
+                const Length limit = rule == OversizeRule::Slab ? limits.slabOversizeMin : limits.shakerOversizeMin;
+                const Length oversize = door.GetDimensions().oversizeHeight;
+                return Fails(rule != OversizeRule::SmallShaker && oversize < limit, oversize, limit);
+            },
+            [](const Door& door, const RuleCheck& check, std::ostream& out) { DescribeUndersize(door, "Height", check, out); }
+        },
+        {
+            DoorRule::OversizeMismatch, false,
+            [](const Door& door, const ValidationLimits&)
+            {
+                const Dimensions& d = door.GetDimensions();
+                return Fails(door.Style().oversize == OversizeRule::Slab && d.oversizeWidth != d.oversizeHeight, d.oversizeHeight, d.oversizeWidth);
+            },
+            [](const Door& door, const RuleCheck&, std::ostream& out)
+            {
+                out << "Oversize Width and Height do not match for " << door.getConstructionString() << " type! \n"
+                    << "Oversize Width: " << door.getOversizeWidth() << " Oversize Height: " << door.getOversizeHeight();
+            }
+        },
+        {
+            DoorRule::OversizeWidthNotExact, false,
+            [](const Door& door, const ValidationLimits& limits)
+            {
+                const Length oversize = door.GetDimensions().oversizeWidth;
+                return Fails(door.Style().oversize == OversizeRule::SmallShaker && oversize != limits.smallShakerOversize, oversize, limits.smallShakerOversize);
+            },
+            [](const Door& door, const RuleCheck& check, std::ostream& out) { DescribeOversize(door, "Width", check, "not", out); }
+        },
+        {
+            DoorRule::OversizeHeightNotExact, false,
+            [](const Door& door, const ValidationLimits& limits)
+            {
+                const Length oversize = door.GetDimensions().oversizeHeight;
+                return Fails(door.Style().oversize == OversizeRule::SmallShaker && oversize != limits.smallShakerOversize, oversize, limits.smallShakerOversize);
+            },
+            [](const Door& door, const RuleCheck& check, std::ostream& out) { DescribeOversize(door, "Height", check, "not", out); }
+        },
+    };
+    static_assert(std::size(Rules) == static_cast<size_t>(DoorRule::COUNT), "Rules out of sync with DoorRule");
+
+    DoorDiagnostic Diagnose(const RuleDef& def, const Door& door, const RuleCheck& check, size_t index)
+    {
+        std::ostringstream text;
+        if (def.removes)
+            text << "Warning: Removed Door " << door.getNameString() << " " << door.getLabelString() << " ";
+        else
+            text << "Warning!! " << door.getNameString() << ", (" << door.getFinishedWidthString(32) << " by "
+                << door.getFinishedHeightString(32) << ") \n";
+
+        def.describe(door, check, text);
+        if (!def.removes)
+            text << " \n";
+
+        return { def.rule, def.removes, static_cast<uint32_t>(index), check.value, check.limit, text.str() };
+    }
+}
+
+ValidationRules& ValidationRules::Global()
+{
+    static ValidationRules rules;
+    return rules;
+}
+
+uint64_t ValidationRules::Fingerprint() const
+{
+    uint64_t hash = Snapshot::HashSeed;
+    for (Length limit : { m_limits.minPanelSize, m_limits.slabOversizeMax, m_limits.slabOversizeMin,
+        m_limits.shakerOversizeMin, m_limits.smallShakerOversize })
+    {
+        const int64_t ticks = limit.Ticks();
+        hash = Snapshot::HashBytes({ reinterpret_cast<const char*>(&ticks), sizeof(ticks) }, hash);
+    }
+    return hash;
+}
+
+void ValidationRules::ValidateRange(std::span<const Door> doors, size_t begin, size_t end,
+    std::vector<uint8_t>& removed, std::vector<DoorDiagnostic>& out) const
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        const Door& door = doors[i];
+        for (const RuleDef& def : Rules)
+        {
+            const RuleCheck check = def.check(door, m_limits);
+            if (!check.fails)
+                continue;
+
+            out.push_back(Diagnose(def, door, check, i));
+            // Removing rules come first, so a removed door gets no warnings
+            if (def.removes)
+            {
+                removed[i] = 1;
+                break;
+            }
+        }
+    }
+}
+
+std::vector<DoorDiagnostic> ValidationRules::Validate(std::span<const Door> doors, std::vector<uint8_t>& removed) const
+{
+    removed.assign(doors.size(), 0);
+    std::vector<DoorDiagnostic> diagnostics;
+
+    size_t chunks = doors.size() / MinChunkDoors;
+    const size_t threads = std::thread::hardware_concurrency();
+    if (chunks > threads)
+        chunks = threads;
+
+    if (chunks < 2)
+    {
+        ValidateRange(doors, 0, doors.size(), removed, diagnostics);
+        return diagnostics;
+    }
+
+    // Each chunk keeps its own list, joined back in door order
+    std::vector<std::vector<DoorDiagnostic>> parts(chunks);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks);
+    const size_t step = doors.size() / chunks;
+
+    for (size_t c = 0; c < chunks; ++c)
+    {
+        const size_t begin = c * step;
+        const size_t end = (c + 1 == chunks) ? doors.size() : begin + step;
+        workers.emplace_back([&, c, begin, end] { ValidateRange(doors, begin, end, removed, parts[c]); });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    for (auto& part : parts)
+        diagnostics.insert(diagnostics.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    return diagnostics;
+}
+
+bool ValidationRules::LoadFile(const std::string& path, std::ostream& log)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        log << "Cannot read validation limits " << path << "\n";
+        return false;
+    }
+
+    struct Key
+    {
+        std::string_view name;
+        Length ValidationLimits::* field;
+    };
+    static constexpr Key Keys[] =
+    {
+        { "min_panel_size", &ValidationLimits::minPanelSize },
+        { "slab_oversize_max", &ValidationLimits::slabOversizeMax },
+        { "slab_oversize_min", &ValidationLimits::slabOversizeMin },
+        { "shaker_oversize_min", &ValidationLimits::shakerOversizeMin },
+        { "small_shaker_oversize", &ValidationLimits::smallShakerOversize },
+    };
+
+    ValidationLimits limits;
+    bool ok = true;
+    size_t lineNumber = 0;
+    std::string line;
+
+    auto fail = [&](const std::string& message)
+        {
+            log << path << ":" << lineNumber << ": " << message << "\n";
+            ok = false;
+        };
+
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        const std::string_view entry = TrimView(line);
+        if (entry.empty() || entry[0] == '#')
+            continue;
+
+        const size_t equals = entry.find('=');
+        if (equals == std::string_view::npos)
+        {
+            fail("expected key = value");
+            continue;
+        }
+
+        const std::string_view name = TrimView(entry.substr(0, equals));
+        const Key* key = nullptr;
+        for (const Key& k : Keys)
+        {
+            if (k.name == name)
+                key = &k;
+        }
+        if (!key)
+        {
+            fail("unknown limit " + std::string(name));
+            continue;
+        }
+
+        double inches = 0.0;
+        if (!ParseInches(entry.substr(equals + 1), inches) || !Length::InRange(inches))
+        {
+            fail("expected a length in inches for " + std::string(name));
+            continue;
+        }
+        limits.*(key->field) = Length::FromInches(inches);
+    }
+
+    if (!ok)
+        return false;
+
+    m_limits = limits;
+    log << "Loaded validation limits from " << path << "\n";
+    return true;
+}
@@ -0,0 +1,109 @@
+﻿#pragma once
+// Optional Windows front-end: picks the CSV with the shell's file dialog.
+// Headless builds (and every non-Windows build) leave it out; define
+// DOOR_NO_FILE_DIALOG to drop it on Windows too.
+#if defined(_WIN32) && !defined(DOOR_NO_FILE_DIALOG)
+#define DOOR_HAS_FILE_DIALOG 1
+#include <string>       // std::string
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>    // GetCurrentDirectoryW, WideCharToMultiByte
+#include <shobjidl.h>   // IFileDialog
+#include <shtypes.h>    // SIGDN_FILESYSPATH
+
+class CsvFileDialog
+{
+public:
+    inline static std::string Open();
+};
+
+//inline std::string CsvFileDialog::Open()
+//{
+//    char fileName[MAX_PATH] = "";
+//
+//    char cwd[MAX_PATH];
+//    GetCurrentDirectoryA(MAX_PATH, cwd);
+//
+//    printf("CWD: %s\n", cwd);
+//
+//    OPENFILENAMEA ofn {};
+//    ofn.lStructSize = sizeof(ofn);
+//    ofn.lpstrFilter =
+//        "CSV Files (*.csv)\0*.csv\0"
+//        "All Files (*.*)\0*.*\0";
+//    ofn.lpstrFile = fileName;
+//    ofn.lpstrInitialDir = cwd;
+//    ofn.nMaxFile = MAX_PATH;
+//    ofn.Flags = OFN_EXPLORER | OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST | OFN_NOCHANGEDIR;
+//    ofn.lpstrDefExt = "csv";
+//
+//    if (GetOpenFileNameA(&ofn))
+//        return fileName;
+//
+//    return {};
+//}
+
+inline std::string CsvFileDialog::Open()
+{
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+    bool comInitialized = SUCCEEDED(hr);
+
+    IFileDialog* pfd = nullptr;
+    std::string result;
+
+    if (SUCCEEDED(CoCreateInstance(CLSID_FileOpenDialog, nullptr,
+        CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&pfd))))
+    {
+        // Build a filter: CSV + All files
+        COMDLG_FILTERSPEC filters[] =
+        {
+            { L"CSV Files (*.csv)", L"*.csv" },
+            { L"All Files (*.*)",   L"*.*"   }
+        };
+        pfd->SetFileTypes(2, filters);
+        pfd->SetDefaultExtension(L"csv");
+        pfd->SetTitle(L"Select CSV File");
+
+        // Get CWD as wide string
+        wchar_t cwd[MAX_PATH];
+        GetCurrentDirectoryW(MAX_PATH, cwd);
+
+        IShellItem* folder = nullptr;
+        if (SUCCEEDED(SHCreateItemFromParsingName(cwd, nullptr, IID_PPV_ARGS(&folder))))
+        {
+            pfd->SetDefaultFolder(folder);
+            pfd->SetFolder(folder);
+            folder->Release();
+        }
+
+        if (SUCCEEDED(pfd->Show(nullptr)))
+        {
+            IShellItem* psi = nullptr;
+            if (SUCCEEDED(pfd->GetResult(&psi)))
+            {
+                PWSTR path = nullptr;
+                if (SUCCEEDED(psi->GetDisplayName(SIGDN_FILESYSPATH, &path)))
+                {
+                    // convert wide → std::string
+                    int size = WideCharToMultiByte(CP_UTF8, 0, path, -1, nullptr, 0, nullptr, nullptr);
+                    std::string utf8(size - 1, 0);
+                    WideCharToMultiByte(CP_UTF8, 0, path, -1, utf8.data(), size, nullptr, nullptr);
+                    result = utf8;
+
+                    CoTaskMemFree(path);
+                }
+                psi->Release();
+            }
+        }
+
+        pfd->Release();
+    }
+
+    if (comInitialized)
+        CoUninitialize();
+
+    return result;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include <string_view>  // std::string_view
+#include <cstring>      // std::memcpy
+#include <cstdint>      // uint8_t
+#include <cstddef>      // size_t
+
+// Text of at most N - 1 characters stored inline, for fields such as a
+// door's name and label. The length is kept beside the characters, so
+// reading is a string_view over them with no strlen and no copy. The text
+// is also NUL-terminated for C APIs. Trivially copyable, so it can live in
+// a snapshot.
+//
+// Text that does not fit is cut to Capacity, and Assign/Append return
+// false so the caller can report it.
+template <size_t N>
+class FixedString
+{
+    static_assert(N >= 2 && N <= 256, "length is kept in one byte");
+
+public:
+    static constexpr size_t Capacity = N - 1;
+
+    constexpr FixedString() = default;
+
+    // Replaces the text; false if it was cut to Capacity
+    bool Assign(std::string_view text)
+    {
+        m_size = 0;
+        m_data[0] = '\0';
+        return Append(text);
+    }
+
+    // Adds to the end; false if the result was cut to Capacity
+    bool Append(std::string_view text)
+    {
+        const size_t room = Capacity - m_size;
+        const size_t count = text.size() < room ? text.size() : room;
+        std::memcpy(m_data + m_size, text.data(), count);
+        m_size = static_cast<uint8_t>(m_size + count);
+        m_data[m_size] = '\0';
+        return count == text.size();
+    }
+
+    std::string_view View() const { return { m_data, m_size }; }
+    operator std::string_view() const { return View(); }
+    const char* c_str() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    bool operator==(const FixedString& other) const { return View() == other.View(); }
+
+private:
+    char m_data[N] = {};
+    uint8_t m_size = 0;
+};
@@ -1,23 +1,232 @@
 ﻿#pragma once
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
+#include <memory_resource>
+#include <initializer_list>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #include <sstream>
-#include <iomanip>
-#include <regex>
 #include <algorithm>
+#include <cmath>
+#include "Length.h"
 #undef min
 
+// Writes into a caller's buffer [first, last). Once a piece does not fit
+// nothing more is written and Result() reports value_too_large, as
+// std::to_chars does.
+class CharSink
+{
+    char* m_pos;
+    char* m_last;
+    bool m_ok = true;
+public:
+    CharSink(char* first, char* last) : m_pos(first), m_last(last) {}
+
+    void Put(std::string_view text)
+    {
+        if (m_ok && text.size() <= static_cast<size_t>(m_last - m_pos))
+        {
+            std::memcpy(m_pos, text.data(), text.size());
+            m_pos += text.size();
+        }
+        else
+            m_ok = false;
+    }
+    void Put(char c)
+    {
+        if (m_ok && m_pos != m_last)
+            *m_pos++ = c;
+        else
+            m_ok = false;
+    }
+    template <typename Int>
+    void PutInt(Int value)
+    {
+        if (!m_ok)
+            return;
+        auto [end, ec] = std::to_chars(m_pos, m_last, value);
+        if (ec == std::errc())
+            m_pos = end;
+        else
+            m_ok = false;
+    }
+
+    std::to_chars_result Result() const
+    {
+        if (m_ok)
+            return { m_pos, std::errc() };
+        return { m_last, std::errc::value_too_large };
+    }
+};
+
+// Text of n/d in lowest terms for every power-of-two d from 2 to 64 and
+// 0 <= n < d, built at compile time. n/d sits at index d - 2 + n.
+namespace FractionTable
+{
+    constexpr int MaxDenominator = 64;
+
+    struct Entry
+    {
+        char text[6];           // "63/64" at most
+        uint8_t size;
+        uint8_t numerator;      // reduced
+        uint8_t denominator;
+
+        constexpr std::string_view Text() const { return { text, size }; }
+    };
+
+    constexpr bool Covers(int denominator)
+    {
+        return denominator >= 2 && denominator <= MaxDenominator && (denominator & (denominator - 1)) == 0;
+    }
+
+    constexpr std::array<Entry, 2 * MaxDenominator - 2> Build()
+    {
+        std::array<Entry, 2 * MaxDenominator - 2> table{};
+        for (int d = 2; d <= MaxDenominator; d *= 2)
+        {
+            for (int n = 0; n < d; ++n)
+            {
+                int rn = n;
+                int rd = d;
+                while (rn != 0 && rn % 2 == 0)
+                {
+                    rn /= 2;
+                    rd /= 2;
+                }
+
+                Entry& entry = table[d - 2 + n];
+                entry.numerator = static_cast<uint8_t>(rn);
+                entry.denominator = static_cast<uint8_t>(rd);
+                auto put = [&entry](int value)
+                    {
+                        if (value >= 10)
+                            entry.text[entry.size++] = static_cast<char>('0' + value / 10);
+                        entry.text[entry.size++] = static_cast<char>('0' + value % 10);
+                    };
+                put(rn);
+                entry.text[entry.size++] = '/';
+                put(rd);
+            }
+        }
+        return table;
+    }
+
+    inline constexpr std::array<Entry, 2 * MaxDenominator - 2> Table = Build();
+
+    constexpr const Entry& Lookup(int numerator, int denominator)
+    {
+        return Table[denominator - 2 + numerator];
+    }
+
+    static_assert(Lookup(8, 32).Text() == "1/4" && Lookup(63, 64).Text() == "63/64" && Lookup(1, 2).Text() == "1/2");
+
+    // "00" to "99", for writing decimals two digits at a time
+    constexpr std::array<char, 200> BuildDigitPairs()
+    {
+        std::array<char, 200> pairs{};
+        for (int i = 0; i < 100; ++i)
+        {
+            pairs[2 * i] = static_cast<char>('0' + i / 10);
+            pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+        }
+        return pairs;
+    }
+
+    inline constexpr std::array<char, 200> DigitPairs = BuildDigitPairs();
+}
 
 class Fraction
 {
-    static bool isEven(int number) { return (number % 2 == 0); }
     double decimalvalue;
+    Length exactvalue;      // set when built from a Length
+    bool exact = false;
     int whole;
     int numerator;
     int denominator;
     int direction;   // -1 = down, 0 = exact, +1 = up
+
+    // Lowest terms from the table when it covers the denominator; other
+    // denominators halve both parts while the numerator is even
+    void Reduce()
+    {
+        if (numerator == 0)
+            return;
+        const int magnitude = numerator < 0 ? -numerator : numerator;
+        if (FractionTable::Covers(denominator) && magnitude < denominator)
+        {
+            const FractionTable::Entry& entry = FractionTable::Lookup(magnitude, denominator);
+            numerator = numerator < 0 ? -entry.numerator : entry.numerator;
+            denominator = entry.denominator;
+            return;
+        }
+        while (numerator % 2 == 0 && numerator != 0 && denominator != 0)
+        {
+            numerator /= 2;
+            denominator /= 2;
+        }
+    }
+
+    void PutFraction(CharSink& out) const
+    {
+        if (numerator > 0 && FractionTable::Covers(denominator))
+            out.Put(FractionTable::Lookup(numerator, denominator).Text());
+        else
+        {
+            out.PutInt(numerator);
+            out.Put('/');
+            out.PutInt(denominator);
+        }
+    }
+
+    void PutDecimal(CharSink& out, bool usedash) const
+    {
+        if (decimalvalue == 0.0)
+        {
+            out.Put(usedash ? "---" : "0\"");
+            return;
+        }
+        char buffer[MaxDecimalSize];
+        auto [end, ec] = exact ? FormatDecimal(buffer, buffer + sizeof(buffer), exactvalue)
+            : FormatDecimal(buffer, buffer + sizeof(buffer), decimalvalue);
+        out.Put(std::string_view(buffer, ec == std::errc() ? end - buffer : 0));
+        out.Put('"');
+    }
+
+    void PutWholeAndFraction(CharSink& out) const
+    {
+        if (numerator != 0 && whole == 0)
+            PutFraction(out);
+        else
+        {
+            out.PutInt(whole);
+            if (numerator != 0)
+            {
+                out.Put(' ');
+                PutFraction(out);
+            }
+        }
+        out.Put('"');
+    }
+
+    static std::string ToString(const char* buffer, std::to_chars_result result)
+    {
+        return std::string(buffer, result.ec == std::errc() ? result.ptr : buffer);
+    }
+
+    template <typename Out>
+    static Out CopyWritten(Out out, const char* buffer, std::to_chars_result result)
+    {
+        return std::copy(buffer, result.ec == std::errc() ? result.ptr : buffer, out);
+    }
+
 public:
+    static constexpr size_t MaxDecimalSize = 352;  // a double's %.4f text
+    static constexpr size_t MaxTextSize = 448;     // anything Write* produces
+
     Fraction(double val, int denom)
         : decimalvalue(val), whole(0), numerator(0), denominator(denom), direction(0)
     {
@@ -26,91 +235,206 @@ public:
 
         whole = rounded / denom;
         numerator = rounded % denom;
+        Reduce();
 
-        if (numerator != 0)
-            while (isEven(numerator) && numerator != 0 && denominator != 0)
-            {
-                numerator /= 2;
-                denominator /= 2;
-            }
         double roundeddecimalvalue = static_cast<double>(whole) + (static_cast<double>(numerator) / static_cast<double>(denominator));
         if (roundeddecimalvalue > val)
             direction++;
         else if (roundeddecimalvalue < val)
             direction--;
     }
-
-    static std::string FormatDecimal(double value)
+    // Exact lengths round with integer arithmetic only
+    Fraction(Length val, int denom)
+        : decimalvalue(val.Inches()), exactvalue(val), exact(true), whole(0), numerator(0), denominator(denom), direction(0)
     {
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(4) << value;
-        std::string s = oss.str();
+        const int64_t rounded = val.Round(denom);
 
-        // Remove trailing zeros
-        s = std::regex_replace(s, std::regex("0+$"), "");
+        whole = static_cast<int>(rounded / denom);
+        numerator = static_cast<int>(rounded % denom);
+        Reduce();
 
-        // If ends with '.', remove it
-        if (!s.empty() && s.back() == '.')
-            s.pop_back();
+        const int64_t roundedticks = rounded * Length::TicksPerInch;
+        const int64_t ticks = val.Ticks() * denom;
+        if (roundedticks > ticks)
+            direction++;
+        else if (roundedticks < ticks)
+            direction--;
+    }
 
-        return s;
+    // value to 4 decimal places with trailing zeros (and a bare '.') trimmed
+    static std::to_chars_result FormatDecimal(char* first, char* last, double value)
+    {
+        auto [end, ec] = std::to_chars(first, last, value, std::chars_format::fixed, 4);
+        if (ec != std::errc())
+            return { end, ec };
+        if (std::find(first, end, '.') != end)
+        {
+            while (end[-1] == '0')
+                --end;
+            if (end[-1] == '.')
+                --end;
+        }
+        return { end, ec };
     }
-    std::string GetDecimalString(bool usedash = false)
+
+    // Same text as FormatDecimal(value.Inches()), from integer arithmetic:
+    // the nearest 0.0001", halves (odd 32nds) to the even step. A half that
+    // is no binary fraction is not exactly halfway once a double, so that
+    // rare case is left to the double.
+    static std::to_chars_result FormatDecimal(char* first, char* last, Length value)
     {
-        if (decimalvalue == 0.0)
+        constexpr int64_t TicksPerStep = Length::TicksPerInch / 10000;
+        constexpr int64_t TicksPerBinaryStep = 625;  // 1/1024"; what is a multiple is a binary fraction
+        const int64_t ticks = value.Ticks() < 0 ? -value.Ticks() : value.Ticks();
+        if (ticks % TicksPerStep == TicksPerStep / 2 && ticks % TicksPerBinaryStep != 0)
+            return FormatDecimal(first, last, value.Inches());
+
+        const int64_t steps = value.RoundHalfEven(10000);
+        const uint64_t magnitude = steps < 0 ? 0 - static_cast<uint64_t>(steps) : static_cast<uint64_t>(steps);
+
+        CharSink out(first, last);
+        if (value.Ticks() < 0)  // "-0" for a hair below zero, as the double path prints
+            out.Put('-');
+        out.PutInt(magnitude / 10000);
+
+        const uint64_t fraction = magnitude % 10000;
+        if (fraction != 0)
         {
-            if (usedash)
-                return "---";
-            else
-                return "0\"";
+            const char* high = &FractionTable::DigitPairs[2 * (fraction / 100)];
+            const char* low = &FractionTable::DigitPairs[2 * (fraction % 100)];
+            const char digits[5] = { '.', high[0], high[1], low[0], low[1] };
+            size_t size = sizeof(digits);
+            while (digits[size - 1] == '0')
+                --size;
+            out.Put(std::string_view(digits, size));
         }
-        return FormatDecimal(decimalvalue) + "\"";
+        return out.Result();
     }
-    std::string GetFractionString()
+
+    static std::string FormatDecimal(double value)
     {
-        if (numerator == 0)
-            return std::to_string(whole) + "\"";
-        else if (whole == 0)
-			return std::to_string(numerator) + "/" + std::to_string(denominator) + "\"";
+        char buffer[MaxDecimalSize];
+        return ToString(buffer, FormatDecimal(buffer, buffer + sizeof(buffer), value));
+    }
+    static std::string FormatDecimal(Length value)
+    {
+        char buffer[32];
+        return ToString(buffer, FormatDecimal(buffer, buffer + sizeof(buffer), value));
+    }
 
-        return std::to_string(whole) + " " + std::to_string(numerator) + "/" + std::to_string(denominator) + "\"";
+    // The Get*String texts, written into [first, last)
+    std::to_chars_result WriteDecimal(char* first, char* last, bool usedash = false) const
+    {
+        CharSink out(first, last);
+        PutDecimal(out, usedash);
+        return out.Result();
+    }
+    std::to_chars_result WriteFraction(char* first, char* last) const
+    {
+        CharSink out(first, last);
+        PutWholeAndFraction(out);
+        return out.Result();
     }
-    std::string GetFractionStringStrong() // up arrow means "Strong" cut a hair above the number, down arrow means cut a hair less
+    // up arrow means "Strong" cut a hair above the number, down arrow means cut a hair less
+    std::to_chars_result WriteFractionStrong(char* first, char* last) const
     {
+        CharSink out(first, last);
         if (numerator == 0)
-            return std::to_string(whole);
+            out.PutInt(whole);
         else if (whole == 0)
-            return std::to_string(numerator) + "/" + std::to_string(denominator) + "\"";
+        {
+            PutFraction(out);
+            out.Put('"');
+        }
+        else
+        {
+            out.PutInt(whole);
+            out.Put(' ');
+            PutFraction(out);
+            out.Put(StrongText());
+        }
+        return out.Result();
+    }
+    std::to_chars_result Write(char* first, char* last, bool usedash = false) const
+    {
+        CharSink out(first, last);
+        PutDecimal(out, usedash);
+        if (decimalvalue != 0.0 && (direction != 0 || numerator != 0))
+        {
+            out.Put(" (");
+            PutWholeAndFraction(out);
+            if (direction != 0)
+            {
+                out.Put(", ");
+                out.Put(RoundingText());
+            }
+            out.Put(')');
+        }
+        return out.Result();
+    }
 
-        return std::to_string(whole) + " " + std::to_string(numerator) + "/" + std::to_string(denominator) + GetStrongString();
+    // The same texts copied to an output iterator, std::format_to style;
+    // each returns the iterator past what it wrote
+    template <typename Out>
+    static Out FormatDecimalTo(Out out, Length value)
+    {
+        char buffer[32];
+        return CopyWritten(out, buffer, FormatDecimal(buffer, buffer + sizeof(buffer), value));
+    }
+    template <typename Out>
+    Out DecimalTo(Out out, bool usedash = false) const
+    {
+        char buffer[MaxTextSize];
+        return CopyWritten(out, buffer, WriteDecimal(buffer, buffer + sizeof(buffer), usedash));
     }
-    std::string GetRoundingString()
+    template <typename Out>
+    Out FractionStrongTo(Out out) const
+    {
+        char buffer[MaxTextSize];
+        return CopyWritten(out, buffer, WriteFractionStrong(buffer, buffer + sizeof(buffer)));
+    }
+    template <typename Out>
+    Out StringTo(Out out, bool usedash = false) const
+    {
+        char buffer[MaxTextSize];
+        return CopyWritten(out, buffer, Write(buffer, buffer + sizeof(buffer), usedash));
+    }
+
+    std::string_view RoundingText() const
     {
         if (direction < 0) return "rounded down";
         else if (direction > 0) return "rounded up";
         else return "";
     }
-    std::string GetStrongString()
+    std::string_view StrongText() const
     {
         if (direction < 0) return "S"; // up
         else if (direction > 0) return "W"; // down
         else return "";
     }
-    std::string GetString(bool usedash = false)
+
+    std::string GetDecimalString(bool usedash = false) const
     {
-        if (decimalvalue == 0.0)
-        {
-            if (usedash)
-                return "---";
-			else
-			    return "0\"";
-        }
-        else if (direction == 0 && numerator != 0)
-            return GetDecimalString() + " (" + GetFractionString() + ")";
-        else if (direction == 0 && numerator == 0)
-            return GetDecimalString();
-        return GetDecimalString() + " (" + GetFractionString() + ", " + GetRoundingString() + ")";
-	}
+        char buffer[MaxTextSize];
+        return ToString(buffer, WriteDecimal(buffer, buffer + sizeof(buffer), usedash));
+    }
+    std::string GetFractionString() const
+    {
+        char buffer[MaxTextSize];
+        return ToString(buffer, WriteFraction(buffer, buffer + sizeof(buffer)));
+    }
+    std::string GetFractionStringStrong() const
+    {
+        char buffer[MaxTextSize];
+        return ToString(buffer, WriteFractionStrong(buffer, buffer + sizeof(buffer)));
+    }
+    std::string GetRoundingString() const { return std::string(RoundingText()); }
+    std::string GetStrongString() const { return std::string(StrongText()); }
+    std::string GetString(bool usedash = false) const
+    {
+        char buffer[MaxTextSize];
+        return ToString(buffer, Write(buffer, buffer + sizeof(buffer), usedash));
+    }
 };
 
 namespace Html
@@ -121,11 +445,9 @@ namespace Html
 
     namespace Util
     {
-        inline std::string Escape(const std::string& text)
+        template <typename String>
+        inline void AppendEscaped(String& out, std::string_view text)
         {
-            std::string out;
-            out.reserve(text.size());
-
             for (char c : text)
             {
                 switch (c)
@@ -138,28 +460,53 @@ namespace Html
                 default:   out += c;        break;
                 }
             }
+        }
+
+        inline std::string Escape(const std::string& text)
+        {
+            std::string out;
+            out.reserve(text.size());
+            AppendEscaped(out, text);
             return out;
         }
+
+        // Numbers as an ostream writes them by default (doubles as %g with
+        // 6 significant digits), without making a stream
+        inline void AppendNumber(std::pmr::string& out, double value)
+        {
+            char buffer[32];
+            auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+            out.append(buffer, ec == std::errc() ? end : buffer);
+        }
+
+        inline void AppendNumber(std::pmr::string& out, int value)
+        {
+            char buffer[16];
+            auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, ec == std::errc() ? end : buffer);
+        }
     }
 
     // ============================================================
     // HtmlTable
     // ============================================================
+    // Cells are kept in the memory resource given at construction, such as
+    // a JobArena's.
     class HtmlTable
     {
     public:
         struct Cell
         {
-            std::string content;
+            std::pmr::string content;   // html, already escaped
             int colspan = 1;
             int rowspan = 1;
             bool rightAlign = false;
 
-            Cell(const std::string& text,
+            Cell(std::pmr::string html,
                 int cs = 1,
                 int rs = 1,
                 bool alignRight = false)
-                : content(text), colspan(cs), rowspan(rs), rightAlign(alignRight)
+                : content(std::move(html)), colspan(cs), rowspan(rs), rightAlign(alignRight)
             {}
         };
 
@@ -170,31 +517,37 @@ namespace Html
             bool rightAlign = false;
         };
 
+        explicit HtmlTable(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+            : m_columns(memory), m_rows(memory)
+        {}
+
         HtmlTable& AddColumn(const Column& col)
         {
-            m_columns.push_back(col);
-            return *this;
+            return AddColumn(col.header, col.width, col.rightAlign);
         }
 
-        HtmlTable& AddRow(const std::vector<std::string>& cells)
+        HtmlTable& AddColumn(std::string_view header, std::string_view width, bool rightAlign = false)
         {
-            std::vector<Cell> row;
-            for (const auto& c : cells)
-                row.emplace_back(Util::Escape(c));
-            m_rows.push_back(row);
+            std::pmr::memory_resource* memory = m_columns.get_allocator().resource();
+            m_columns.push_back({ std::pmr::string(header, memory), std::pmr::string(width, memory), rightAlign });
             return *this;
         }
 
-        HtmlTable& AddKeyValue(const std::string& key,
-            const std::string& value)
+        HtmlTable& AddRow(std::initializer_list<std::string_view> cells)
         {
-            m_rows.push_back({
-                Cell(Util::Escape(key)),
-                Cell(Util::Escape(value))
-                });
+            auto& row = m_rows.emplace_back();
+            row.reserve(cells.size());
+            for (std::string_view c : cells)
+                row.emplace_back(Escaped(c));
             return *this;
         }
 
+        HtmlTable& AddKeyValue(std::string_view key,
+            std::string_view value)
+        {
+            return AddRow({ key, value });
+        }
+
 
         HtmlTable& BeginRow()
         {
@@ -214,73 +567,160 @@ namespace Html
 
         std::string ToHtml() const
         {
-            std::ostringstream html;
-            html << "<table>\n";
+            std::pmr::string html;
+            AppendHtml(html);
+            return std::string(html);
+        }
+
+        void AppendHtml(std::pmr::string& html) const
+        {
+            html += "<table>\n";
 
             if (!m_columns.empty())
             {
-                html << "<thead><tr>";
+                html += "<thead><tr>";
                 for (const auto& col : m_columns)
                 {
-                    html << "<th";
+                    html += "<th";
                     if (!col.width.empty())
-                        html << " style='width:" << col.width << ";'";
-                    html << ">";
-                    html << Util::Escape(col.header);
-                    html << "</th>";
+                    {
+                        html += " style='width:";
+                        html += col.width;
+                        html += ";'";
+                    }
+                    html += ">";
+                    Util::AppendEscaped(html, col.header);
+                    html += "</th>";
                 }
-                html << "</tr></thead>\n";
+                html += "</tr></thead>\n";
             }
 
-            html << "<tbody>\n";
+            html += "<tbody>\n";
             for (const auto& row : m_rows)
             {
-                html << "<tr>";
+                html += "<tr>";
                 size_t colIndex = 0;
 
                 for (const auto& cell : row)
                 {
-                    html << "<td";
+                    html += "<td";
 
                     if (cell.colspan > 1)
-                        html << " colspan='" << cell.colspan << "'";
+                    {
+                        html += " colspan='";
+                        Util::AppendNumber(html, cell.colspan);
+                        html += "'";
+                    }
                     if (cell.rowspan > 1)
-                        html << " rowspan='" << cell.rowspan << "'";
+                    {
+                        html += " rowspan='";
+                        Util::AppendNumber(html, cell.rowspan);
+                        html += "'";
+                    }
 
                     bool alignRight = cell.rightAlign ||
                         (colIndex < m_columns.size() && m_columns[colIndex].rightAlign);
 
                     if (alignRight)
-                        html << " style='text-align:right;'";
+                        html += " style='text-align:right;'";
 
-                    html << ">";
-                    html << cell.content;
-                    html << "</td>";
+                    html += ">";
+                    html += cell.content;
+                    html += "</td>";
 
                     colIndex += cell.colspan;
                 }
-                html << "</tr>\n";
+                html += "</tr>\n";
             }
-            html << "</tbody></table>\n";
+            html += "</tbody></table>\n";
+        }
 
+    private:
+        std::pmr::string Escaped(std::string_view text) const
+        {
+            std::pmr::string html(m_rows.get_allocator());
+            html.reserve(text.size());
+            Util::AppendEscaped(html, text);
+            return html;
+        }
 
-            return html.str();
+        // A Column, kept in the table's memory resource
+        struct StoredColumn
+        {
+            std::pmr::string header;
+            std::pmr::string width;
+            bool rightAlign = false;
+        };
+
+        std::pmr::vector<StoredColumn> m_columns;
+        std::pmr::vector<std::pmr::vector<Cell>> m_rows;
+
+    };
+
+    // ============================================================
+    // FileSink
+    // ============================================================
+    // A file written through one large buffer. Text is appended straight
+    // into Buffer(); Drain() writes it out once FlushBytes have built up, so
+    // however long the file gets, no more than that (plus whatever was
+    // appended since) is ever held in memory.
+    class FileSink
+    {
+    public:
+        static constexpr size_t FlushBytes = 1 << 20;
+
+        explicit FileSink(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+            : m_buffer(memory)
+        {}
+
+        bool Open(const std::string& path)
+        {
+            m_file.open(path, std::ios::out | std::ios::trunc);
+            if (!m_file.is_open())
+                return false;
+            m_buffer.reserve(FlushBytes);
+            return true;
         }
 
-    private:
-        std::vector<Column> m_columns;
-        std::vector<std::vector<Cell>> m_rows;
+        bool IsOpen() const { return m_file.is_open(); }
+
+        std::pmr::string& Buffer() { return m_buffer; }
+
+        void Drain()
+        {
+            if (m_buffer.size() >= FlushBytes)
+                Flush();
+        }
+
+        void Flush()
+        {
+            m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.clear();
+        }
+
+        // Writes what is left; false if any write failed
+        bool Close()
+        {
+            Flush();
+            m_file.close();
+            return !m_file.fail();
+        }
 
+    private:
+        std::ofstream m_file;
+        std::pmr::string m_buffer;
     };
 
     // ============================================================
     // HtmlDocument
     // ============================================================
+    // The document is built in the memory resource given at construction,
+    // such as a JobArena's.
     class HtmlDocument
     {
     public:
-        explicit HtmlDocument(const std::string& title)
-            : m_title(title)
+        explicit HtmlDocument(std::string_view title, std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+            : m_title(title, memory), m_styles(memory), m_body(memory), m_sink(memory)
         {
             // Default styles: print-safe, shop-friendly
             m_styles = R"(
@@ -352,82 +792,126 @@ namespace Html
 
         // ---------------- Document structure ----------------
 
-        void AddStyle(const std::string& css)
+        void AddStyle(std::string_view css)
         {
-            m_styles += "\n" + css;
+            m_styles += "\n";
+            m_styles += css;
         }
 
-        void AddHeading(const std::string& text, int level = 1)
+        void AddHeading(std::string_view text, int level = 1)
         {
             if (level < 1) level = 1;
             if (level > 6) level = 6;
 
-            m_body += "<h" + std::to_string(level) + ">"
-                + Util::Escape(text)
-                + "</h" + std::to_string(level) + ">\n";
+            std::pmr::string& body = Body();
+            body += "<h";
+            Util::AppendNumber(body, level);
+            body += ">";
+            Util::AppendEscaped(body, text);
+            body += "</h";
+            Util::AppendNumber(body, level);
+            body += ">\n";
+            Appended();
         }
 
-        void AddParagraph(const std::string& text)
+        void AddParagraph(std::string_view text)
         {
-            m_body += "<p>" + Util::Escape(text) + "</p>\n";
+            std::pmr::string& body = Body();
+            body += "<p>";
+            Util::AppendEscaped(body, text);
+            body += "</p>\n";
+            Appended();
         }
 
-        void AddRawHtml(const std::string& html)
+        void AddRawHtml(std::string_view html)
         {
-            m_body += html + "\n";
+            std::pmr::string& body = Body();
+            body += html;
+            body += "\n";
+            Appended();
         }
 
         void AddTable(const HtmlTable& table)
         {
-            m_body += table.ToHtml();
+            table.AppendHtml(Body());
+            Appended();
+        }
+
+        // Html made earlier, such as HtmlTable::AppendHtml output kept for reuse
+        void AddRenderedHtml(std::string_view html)
+        {
+            Body() += html;
+            Appended();
         }
 
         void AddPageBreak()
         {
-            m_body += "<div style='page-break-after: always;'></div>\n";
+            Body() += "<div style='page-break-after: always;'></div>\n";
+            Appended();
         }
 
         // ---------------- Grid / Block helpers ----------------
 
-        void BeginGrid(const std::string& className)
+        void BeginGrid(std::string_view className)
         {
-            m_body += "<div class='" + className + "'>\n";
+            BeginBlock(className);
         }
 
         void EndGrid()
         {
-            m_body += "</div>\n";
+            Body() += "</div>\n";
+            Appended();
         }
 
-        void BeginBlock(const std::string& className)
+        void BeginBlock(std::string_view className)
         {
-            m_body += "<div class='" + className + "'>\n";
+            std::pmr::string& body = Body();
+            body += "<div class='";
+            body += className;
+            body += "'>\n";
+            Appended();
         }
 
         void EndBlock()
         {
-            m_body += "</div>\n";
+            Body() += "</div>\n";
+            Appended();
         }
 
         // ---------------- Output ----------------
 
-        std::string ToString() const
+        // Streams the document to path instead of keeping it: the head and
+        // styles are written now, so every AddStyle must come first. From
+        // here on the body goes out through a FileSink as it is added, and
+        // Finish() writes the closing tags. A report of any length then
+        // needs only the sink's buffer and the piece being added.
+        bool BeginFile(const std::string& path)
         {
-            std::ostringstream html;
-
-            html << "<!DOCTYPE html>\n";
-            html << "<html>\n<head>\n";
-            html << "<meta charset='utf-8'>\n";
-            html << "<title>" << Util::Escape(m_title) << "</title>\n";
-            html << "<style>\n" << m_styles << "\n</style>\n";
-            html << "<body>\n";
-            html << "<div class='page'><div class='page-inner'>\n";
-            html << m_body;
-            html << "</div></div>\n";
-            html << "</body>\n";
+            if (!m_sink.Open(path))
+                return false;
+            std::pmr::string& out = m_sink.Buffer();
+            AppendHead(out);
+            out += m_body;
+            m_body.clear();
+            m_sink.Drain();
+            return true;
+        }
 
+        // Ends a document begun with BeginFile; false if writing failed
+        bool Finish()
+        {
+            m_sink.Buffer() += Tail;
+            return m_sink.Close();
+        }
 
-            return html.str();
+        std::string ToString() const
+        {
+            std::string html;
+            html.reserve(m_styles.size() + m_body.size() + 256);
+            AppendHead(html);
+            html += m_body;
+            html += Tail;
+            return html;
         }
 
         bool WriteToFile(const std::string& path) const
@@ -436,14 +920,46 @@ namespace Html
             if (!file.is_open())
                 return false;
 
-            file << ToString();
+            std::pmr::string head(m_body.get_allocator());
+            AppendHead(head);
+            file << head << m_body << Tail;
             return true;
         }
 
     private:
-        std::string m_title;
-        std::string m_styles;
-        std::string m_body;
+        static constexpr std::string_view Tail = "</div></div>\n</body>\n";
+
+        template <typename String>
+        void AppendHead(String& html) const
+        {
+            html += "<!DOCTYPE html>\n";
+            html += "<html>\n<head>\n";
+            html += "<meta charset='utf-8'>\n";
+            html += "<title>";
+            Util::AppendEscaped(html, m_title);
+            html += "</title>\n";
+            html += "<style>\n";
+            html += m_styles;
+            html += "\n</style>\n";
+            html += "<body>\n";
+            html += "<div class='page'><div class='page-inner'>\n";
+        }
+
+        std::pmr::string& Body()
+        {
+            return m_sink.IsOpen() ? m_sink.Buffer() : m_body;
+        }
+
+        void Appended()
+        {
+            if (m_sink.IsOpen())
+                m_sink.Drain();
+        }
+
+        std::pmr::string m_title;
+        std::pmr::string m_styles;
+        std::pmr::string m_body;    // until BeginFile
+        FileSink m_sink;
     };
 }
 
@@ -554,34 +1070,56 @@ namespace Html::Svg
             return *this;
         }
 
-        DoorDiagram& SetLabel(const std::string& text)
+        DoorDiagram& SetLabel(std::string_view text)
         {
-            m_label = text;
+            m_label.assign(text);
             return *this;
         }
 
         std::string ToHtml() const
         {
-            std::ostringstream svg;
+            std::pmr::string svg;
+            AppendShape(svg);
+            AppendLabel(svg);
+            return std::string(svg);
+        }
 
-            svg << "<svg class='door-diagram' "
-                << "width='" << m_width << "' "
-                << "height='" << m_height << "' "
-                << "viewBox='" << m_vbX << " " << m_vbY << " "
-                << m_vbW << " " << m_vbH << "' "
-                << "preserveAspectRatio = 'xMidYMid meet'"
-                << "xmlns='http://www.w3.org/2000/svg'>\n";
+        // The drawing up to its label: all that doors of one build share
+        void AppendShape(std::pmr::string& svg) const
+        {
+            svg += "<svg class='door-diagram' width='";
+            Util::AppendNumber(svg, m_width);
+            svg += "' height='";
+            Util::AppendNumber(svg, m_height);
+            svg += "' viewBox='";
+            Util::AppendNumber(svg, m_vbX);
+            svg += " ";
+            Util::AppendNumber(svg, m_vbY);
+            svg += " ";
+            Util::AppendNumber(svg, m_vbW);
+            svg += " ";
+            Util::AppendNumber(svg, m_vbH);
+            svg += "' preserveAspectRatio = 'xMidYMid meet'xmlns='http://www.w3.org/2000/svg'>\n";
 
             DrawOuter(svg);
 
             if (m_style != DoorStyle::Slab)
                 DrawFrame(svg);
+        }
 
-            DrawLabel(svg);
+        // The label and the end of the drawing
+        void AppendLabel(std::pmr::string& svg) const
+        {
+            AppendLabel(svg, m_label);
+        }
 
-            svg << "</svg>";
+        // With label in place of SetLabel's, so one diagram can be shared
+        // by doors drawn at the same time
+        void AppendLabel(std::pmr::string& svg, std::string_view label) const
+        {
+            DrawLabel(svg, label);
 
-            return svg.str();
+            svg += "</svg>";
         }
 
     private:
@@ -600,20 +1138,20 @@ namespace Html::Svg
         std::string m_label;
         double m_Scale_Factor = 0.98;
 
-        void DrawOuter(std::ostringstream& svg) const
+        void DrawOuter(std::pmr::string& svg) const
         {
             double w = m_vbW;
             double h = m_vbH;
-            svg << Rect(0,0,w,h);
+            Rect(svg, 0,0,w,h);
             //bone detail
-            svg << Line(0, 0, m_bonedetail, m_bonedetail);
-            svg << Line(w - m_bonedetail, m_bonedetail, w, 0);
-            svg << Line(0, h, m_bonedetail, h - m_bonedetail);
-            svg << Line(w - m_bonedetail, h - m_bonedetail, w, h);
-            svg << Rect(m_bonedetail, m_bonedetail, w - m_bonedetail * 2, h - m_bonedetail * 2);
+            Line(svg, 0, 0, m_bonedetail, m_bonedetail);
+            Line(svg, w - m_bonedetail, m_bonedetail, w, 0);
+            Line(svg, 0, h, m_bonedetail, h - m_bonedetail);
+            Line(svg, w - m_bonedetail, h - m_bonedetail, w, h);
+            Rect(svg, m_bonedetail, m_bonedetail, w - m_bonedetail * 2, h - m_bonedetail * 2);
         }
 
-        void DrawFrame(std::ostringstream& svg) const
+        void DrawFrame(std::pmr::string& svg) const
         {
             double w = m_vbW;
             double h = m_vbH;
@@ -621,12 +1159,12 @@ namespace Html::Svg
             if (m_style == DoorStyle::Shaker)
             {
                 // Stiles
-                svg << Rect(m_bonedetail, m_bonedetail, m_LeftStile, h - m_bonedetail * 2);
-                svg << Rect(w - m_bonedetail - m_RightStile , m_bonedetail, m_RightStile, h - m_bonedetail * 2);
+                Rect(svg, m_bonedetail, m_bonedetail, m_LeftStile, h - m_bonedetail * 2);
+                Rect(svg, w - m_bonedetail - m_RightStile , m_bonedetail, m_RightStile, h - m_bonedetail * 2);
 
                 // Rails
-                svg << Rect(m_bonedetail + m_LeftStile, m_bonedetail, w - (m_LeftStile + m_RightStile + m_bonedetail * 2) , m_TopRail);
-                svg << Rect(m_bonedetail + m_LeftStile, h-(m_BottomRail + m_bonedetail), w - (m_LeftStile + m_RightStile + m_bonedetail * 2), m_BottomRail);
+                Rect(svg, m_bonedetail + m_LeftStile, m_bonedetail, w - (m_LeftStile + m_RightStile + m_bonedetail * 2) , m_TopRail);
+                Rect(svg, m_bonedetail + m_LeftStile, h-(m_BottomRail + m_bonedetail), w - (m_LeftStile + m_RightStile + m_bonedetail * 2), m_BottomRail);
 
 
 				double panelheight = (h - (m_bonedetail * 2 + m_TopRail + m_BottomRail + m_MidWidth * m_midrailCount)) / (m_midrailCount + 1);
@@ -634,7 +1172,7 @@ namespace Html::Svg
                 for (int i = 0; i < m_midrailCount; ++i)
                 {
                     double railY = m_bonedetail + m_TopRail + (i+1) * panelheight + (m_MidWidth * i);
-                    svg << Rect(m_bonedetail + m_LeftStile, railY, w - (m_bonedetail * 2 + m_LeftStile + m_RightStile), m_MidWidth);
+                    Rect(svg, m_bonedetail + m_LeftStile, railY, w - (m_bonedetail * 2 + m_LeftStile + m_RightStile), m_MidWidth);
 				}
                 for (int ix = 0; ix < m_midrailCount + 1; ++ix)
                 {
@@ -642,17 +1180,17 @@ namespace Html::Svg
                     {
 						double panelTopY = m_bonedetail + m_TopRail + (ix * panelheight) + (ix * m_MidWidth);
                         double stileX = m_bonedetail + m_LeftStile + ((i+1) * panelwidth) + (i * m_MidWidth);
-                        svg << Rect(stileX, panelTopY, m_MidWidth, panelheight);
+                        Rect(svg, stileX, panelTopY, m_MidWidth, panelheight);
 					}
                 }
             }
             if (m_style == DoorStyle::ShakerMitered)
             {
-                svg << Line(m_bonedetail, m_bonedetail, m_bonedetail+m_LeftStile, m_bonedetail+m_TopRail);
-                svg << Line(w - (m_RightStile + m_bonedetail), m_TopRail + m_bonedetail, w- m_bonedetail, m_bonedetail);
-                svg << Line(m_bonedetail, h- m_bonedetail, m_LeftStile + m_bonedetail, h - m_BottomRail - m_bonedetail);
-                svg << Line(w - m_bonedetail - m_RightStile, h - m_bonedetail - m_BottomRail, w - m_bonedetail, h - m_bonedetail);
-                svg << Rect(m_bonedetail + m_LeftStile, m_bonedetail + m_TopRail, w - (m_bonedetail+m_LeftStile + m_bonedetail + m_RightStile), h - (m_bonedetail + m_bonedetail + m_TopRail + m_BottomRail));
+                Line(svg, m_bonedetail, m_bonedetail, m_bonedetail+m_LeftStile, m_bonedetail+m_TopRail);
+                Line(svg, w - (m_RightStile + m_bonedetail), m_TopRail + m_bonedetail, w- m_bonedetail, m_bonedetail);
+                Line(svg, m_bonedetail, h- m_bonedetail, m_LeftStile + m_bonedetail, h - m_BottomRail - m_bonedetail);
+                Line(svg, w - m_bonedetail - m_RightStile, h - m_bonedetail - m_BottomRail, w - m_bonedetail, h - m_bonedetail);
+                Rect(svg, m_bonedetail + m_LeftStile, m_bonedetail + m_TopRail, w - (m_bonedetail+m_LeftStile + m_bonedetail + m_RightStile), h - (m_bonedetail + m_bonedetail + m_TopRail + m_BottomRail));
             }
         }
         double scaleX(double x) const
@@ -667,33 +1205,46 @@ namespace Html::Svg
             return cy + (y - cy) * m_Scale_Factor;
         }
 
-        std::string Rect(double x, double y, double w, double h) const
+        void Rect(std::pmr::string& svg, double x, double y, double w, double h) const
         {
             x = scaleX(x);
             y = scaleY(y);
             w = w * m_Scale_Factor;
             h = h * m_Scale_Factor;
-            std::ostringstream r;
-            r << "<rect x='" << x << "' y='" << y
-                << "' width='" << w << "' height='" << h
-                << "' fill='none' stroke='black' "
-                << "stroke-width='" << m_stroke << "'/>\n";
-            return r.str();
+            svg += "<rect x='";
+            Util::AppendNumber(svg, x);
+            svg += "' y='";
+            Util::AppendNumber(svg, y);
+            svg += "' width='";
+            Util::AppendNumber(svg, w);
+            svg += "' height='";
+            Util::AppendNumber(svg, h);
+            AppendStroke(svg);
         }
-        std::string Line(double x1, double y1, double x2, double y2) const
+        void Line(std::pmr::string& svg, double x1, double y1, double x2, double y2) const
         {
             x1 = scaleX(x1);
             x2 = scaleX(x2);
             y1 = scaleY(y1);
             y2 = scaleY(y2);
-            std::ostringstream r;
-            r << "<line x1='" << x1 << "' y1='" << y1 << " ' x2 ='" << x2 << "' y2 ='" << y2 
-                << "' fill='none' stroke='black' "
-                << "stroke-width='" << m_stroke << "'/>\n";
-            return r.str();
+            svg += "<line x1='";
+            Util::AppendNumber(svg, x1);
+            svg += "' y1='";
+            Util::AppendNumber(svg, y1);
+            svg += " ' x2 ='";
+            Util::AppendNumber(svg, x2);
+            svg += "' y2 ='";
+            Util::AppendNumber(svg, y2);
+            AppendStroke(svg);
+        }
+        void AppendStroke(std::pmr::string& svg) const
+        {
+            svg += "' fill='none' stroke='black' stroke-width='";
+            Util::AppendNumber(svg, m_stroke);
+            svg += "'/>\n";
         }
 
-        void DrawLabel(std::ostringstream& svg) const
+        void DrawLabel(std::pmr::string& svg, std::string_view label) const
         {
             double cx = m_vbX + m_vbW / 2.0;
             double cy = m_vbY + m_vbH / 2.0;
@@ -706,15 +1257,15 @@ namespace Html::Svg
             double desiredPx = 10.0;
             double fontUnits = desiredPx / scale;   // convert px → SVG units
 
-            svg
-                << "<text x='" << cx
-                << "' y='" << cy
-                << "' text-anchor='middle'"
-                << " dominant-baseline='middle'"
-                << " font-size='" << fontUnits << "'"
-                << " fill='black'>"
-                << m_label
-                << "</text>\n";
+            svg += "<text x='";
+            Util::AppendNumber(svg, cx);
+            svg += "' y='";
+            Util::AppendNumber(svg, cy);
+            svg += "' text-anchor='middle' dominant-baseline='middle' font-size='";
+            Util::AppendNumber(svg, fontUnits);
+            svg += "' fill='black'>";
+            svg += label;
+            svg += "</text>\n";
         }
     };
 }
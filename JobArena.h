@@ -0,0 +1,85 @@
+#pragma once
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::monotonic_buffer_resource
+#include <cstddef>         // size_t
+
+// Counts the allocations that pass through it on their way to upstream.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream)
+        : m_upstream(upstream)
+    {}
+
+    size_t Allocations() const { return m_allocations; }
+    size_t Bytes() const { return m_bytes; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++m_allocations;
+        m_bytes += bytes;
+        return m_upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        m_upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* m_upstream;
+    size_t m_allocations = 0;
+    size_t m_bytes = 0;
+};
+
+// Memory for one job's short-lived text: report strings, tables, label and
+// cut lists. Allocations bump a pointer through blocks taken from the heap,
+// frees are no-ops, and every block goes back at once when the arena is
+// destroyed at the end of the job. Like a job, an arena belongs to one
+// thread.
+class JobArena
+{
+public:
+    static constexpr size_t InitialBlockBytes = 64 * 1024;
+
+    struct Stats
+    {
+        size_t allocations = 0;     // asked of the arena
+        size_t bytes = 0;
+        size_t blocks = 0;          // heap allocations the arena made itself
+        size_t blockBytes = 0;
+
+        // Heap allocations (and as many frees) the job did not make
+        size_t MallocsSaved() const { return allocations > blocks ? allocations - blocks : 0; }
+    };
+
+    JobArena()
+        : m_blocks(std::pmr::new_delete_resource()),
+        m_arena(InitialBlockBytes, &m_blocks),
+        m_requests(&m_arena)
+    {}
+
+    JobArena(const JobArena&) = delete;
+    JobArena& operator=(const JobArena&) = delete;
+
+    std::pmr::memory_resource* Resource() { return &m_requests; }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.allocations = m_requests.Allocations();
+        stats.bytes = m_requests.Bytes();
+        stats.blocks = m_blocks.Allocations();
+        stats.blockBytes = m_blocks.Bytes();
+        return stats;
+    }
+
+private:
+    CountingResource m_blocks;      // what the arena takes from the heap
+    std::pmr::monotonic_buffer_resource m_arena;
+    CountingResource m_requests;    // what the job asks of the arena
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <string>        // std::string
+#include <vector>        // std::vector
+#include <map>           // std::map
+#include <set>           // std::set
+#include <unordered_map> // std::unordered_map
+#include <cstdint>       // uint64_t
+#include <fstream>       // std::ifstream, std::ofstream
+#include <sstream>       // std::istringstream
+#include <filesystem>    // std::filesystem::exists
+
+// What a job run wrote and what each output was made from: a content hash
+// per door and, per output file, the doors that went into it (in output
+// order) plus a hash of everything else it depends on, like the job name.
+// Comparing the manifests of two runs gives the outputs a change order
+// actually touched.
+class JobManifest
+{
+public:
+    struct Output
+    {
+        uint64_t inputs = 0;
+        std::vector<uint64_t> doors;
+    };
+
+    // Returns false if the key is already taken; the manifest is then no
+    // use for telling doors apart.
+    bool AddDoor(uint64_t key, uint64_t contentHash)
+    {
+        return m_doors.emplace(key, contentHash).second;
+    }
+
+    // Records that door `key` goes into output. Outputs with no doors are
+    // declared with AddOutput.
+    void AddContributor(const std::string& output, uint64_t inputs, uint64_t key)
+    {
+        Output& entry = AddOutput(output, inputs);
+        if (entry.doors.empty() || entry.doors.back() != key)
+            entry.doors.push_back(key);
+    }
+
+    Output& AddOutput(const std::string& output, uint64_t inputs)
+    {
+        Output& entry = m_outputs[output];
+        entry.inputs = inputs;
+        return entry;
+    }
+
+    size_t OutputCount() const { return m_outputs.size(); }
+
+    // Outputs that are new, missing under root, made from different inputs
+    // or doors, or made from a door whose content changed since previous.
+    std::set<std::string> StaleOutputs(const JobManifest& previous, const std::filesystem::path& root) const
+    {
+        std::set<std::string> stale;
+
+        for (const auto& [path, output] : m_outputs)
+        {
+            auto old = previous.m_outputs.find(path);
+            bool changed = old == previous.m_outputs.end()
+                || old->second.inputs != output.inputs
+                || old->second.doors != output.doors
+                || !std::filesystem::exists(root / path);
+
+            for (size_t i = 0; i < output.doors.size() && !changed; ++i)
+            {
+                auto before = previous.m_doors.find(output.doors[i]);
+                changed = before == previous.m_doors.end()
+                    || before->second != m_doors.at(output.doors[i]);
+            }
+
+            if (changed)
+                stale.insert(path);
+        }
+        return stale;
+    }
+
+    // Text format, one record per line:
+    //   D <door key> <content hash>
+    //   O <inputs> <door count> <door keys...> <path to end of line>
+    bool Load(const std::string& path)
+    {
+        std::ifstream in(path);
+        std::string line;
+        if (!std::getline(in, line) || line != Magic)
+            return false;
+
+        m_doors.clear();
+        m_outputs.clear();
+
+        while (std::getline(in, line))
+        {
+            std::istringstream fields(line);
+            char kind = 0;
+            fields >> kind >> std::hex;
+
+            if (kind == 'D')
+            {
+                uint64_t key = 0, hash = 0;
+                if (!(fields >> key >> hash))
+                    return false;
+                m_doors[key] = hash;
+            }
+            else if (kind == 'O')
+            {
+                Output output;
+                size_t count = 0;
+                if (!(fields >> output.inputs >> count))
+                    return false;
+
+                output.doors.resize(count);
+                for (uint64_t& key : output.doors)
+                    fields >> key;
+
+                std::string file;
+                if (!fields || fields.get() != ' ' || !std::getline(fields, file))
+                    return false;
+                m_outputs[file] = std::move(output);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Save(const std::string& path) const
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+            return false;
+
+        out << Magic << "\n" << std::hex;
+        for (const auto& [key, hash] : m_doors)
+            out << "D " << key << " " << hash << "\n";
+
+        for (const auto& [file, output] : m_outputs)
+        {
+            out << "O " << output.inputs << " " << output.doors.size();
+            for (uint64_t key : output.doors)
+                out << " " << key;
+            out << " " << file << "\n";
+        }
+        return static_cast<bool>(out);
+    }
+
+private:
+    static constexpr const char* Magic = "DOOR-MANIFEST 1";
+
+    std::unordered_map<uint64_t, uint64_t> m_doors;
+    std::map<std::string, Output> m_outputs;
+};
@@ -0,0 +1,226 @@
+﻿#pragma once
+#include <string>       // std::string
+#include <vector>       // std::vector
+#include <fstream>      // std::ifstream, std::ofstream
+#include <sstream>      // std::ostringstream
+#include <iostream>     // std::cout
+#include <filesystem>   // std::filesystem::path
+#include <thread>       // std::thread
+#include <atomic>       // std::atomic
+#include <mutex>        // std::mutex
+#include <set>          // std::set
+#include <exception>    // std::exception
+#include "Door.h"
+#include "CsvUtils.h"
+#include "JobArena.h"
+
+// One job: a door CSV, the name stamped on its outputs, and the folder they
+// are written to. Jobs share nothing, so any number can run at once.
+struct DoorJob
+{
+    std::string csvPath;
+    std::string name;
+    std::filesystem::path outputRoot;   // empty: the working directory
+    bool consolidatedReport = false;    // one report block per set of identical doors
+    bool reportArena = false;           // log what the job's arena saved
+    unsigned int reportThreads = 1;     // drawing the door report; 0 is one per core
+};
+
+// Reads the CSV and writes every output of the job, logging to log.
+// The job's short-lived text lives in one arena, freed when it returns.
+// Returns false if no doors could be read, and then writes nothing, not
+// even a manifest, so the outputs of an earlier run are left as they were.
+inline bool RunDoorJob(const DoorJob& job, std::ostream& log)
+{
+    JobArena arena;
+    DoorList doorlist(job.csvPath, log, arena.Resource());
+    if (doorlist.GetDoorCount() == 0)
+        return false;
+
+    if (!job.outputRoot.empty())
+        std::filesystem::create_directories(job.outputRoot);
+    doorlist.SetOutputRoot(job.outputRoot);
+    doorlist.SetConsolidatedReport(job.consolidatedReport);
+    doorlist.SetReportThreads(job.reportThreads);
+
+    doorlist.PlanOutputs(job.name);
+    doorlist.WriteHTMLReport(job.name.c_str());
+    if (doorlist.HasShaker())
+    {
+        doorlist.WriteTigerStopCsvs(job.name);
+        doorlist.WriteShakerLabelCsv(job.name);
+    }
+    doorlist.WriteSlabLabelCsv(job.name);
+    doorlist.WritePanelCsvs(job.name);
+    doorlist.SaveOutputManifest(job.name);
+    //doorlist.Print();
+    doorlist.OverSize_SanityCheck();
+
+    double linearfootage = doorlist.GetTotalLinearFootage();
+    double bonedetaillinearfootage = doorlist.GetTotalLinearFootageBoneDetail();
+    if (linearfootage > 0.1)
+    {
+        log << "Linear Footage of Rails and Stiles: " << linearfootage << "\n";
+    }
+    if (bonedetaillinearfootage > 0.1)
+    {
+        log << "Linear Footage of Bone Detail: " << bonedetaillinearfootage << "\n";
+    }
+
+    if (job.reportArena)
+    {
+        const JobArena::Stats stats = arena.GetStats();
+        log << "Arena: " << stats.allocations << " allocations (" << stats.bytes << " bytes) from "
+            << stats.blocks << " heap blocks (" << stats.blockBytes << " bytes), "
+            << stats.MallocsSaved() << " malloc calls saved\n";
+    }
+
+    return true;
+}
+
+// The CSV of a job folder: its only .csv that is not one of our own outputs.
+// Returns an empty string if there is none or more than one.
+inline std::string FindJobCsv(const std::filesystem::path& folder)
+{
+    std::string found;
+    std::error_code ec;
+
+    for (const auto& entry : std::filesystem::directory_iterator(folder, ec))
+    {
+        const std::filesystem::path& path = entry.path();
+        if (!entry.is_regular_file() || path.extension() != ".csv")
+            continue;
+        if (path.filename() == "LabelsList.csv" || path.filename() == "SlabLabelsList.csv")
+            continue;
+        if (!found.empty())
+            return {};
+        found = path.string();
+    }
+    return found;
+}
+
+// Job list file: one job folder or CSV per line; blank lines and lines
+// starting with # are skipped. A job is named and rooted as if the program
+// had been started in its folder (a CSV's folder is the one holding it);
+// with outRoot set, each job writes to outRoot/<job name> instead.
+// skipped counts the entries that cannot be run, which the batch reports
+// as failed jobs.
+inline std::vector<DoorJob> ReadJobList(const std::string& listPath, const std::filesystem::path& outRoot, std::ostream& log, size_t& skipped)
+{
+    std::vector<DoorJob> jobs;
+    std::set<std::filesystem::path> roots;
+    skipped = 0;
+
+    std::ifstream in(listPath);
+    if (!in)
+    {
+        log << "Cannot read job list " << listPath << "\n";
+        return jobs;
+    }
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const std::string entry = Trim(line);
+        if (entry.empty() || entry[0] == '#')
+            continue;
+
+        std::error_code ec;
+        std::filesystem::path path = std::filesystem::absolute(entry, ec).lexically_normal();
+        if (!path.has_filename())
+            path = path.parent_path();
+
+        DoorJob job;
+        std::filesystem::path folder;
+        if (std::filesystem::is_directory(path, ec))
+        {
+            folder = path;
+            job.csvPath = FindJobCsv(folder);
+        }
+        else if (std::filesystem::is_regular_file(path, ec))
+        {
+            folder = path.parent_path();
+            job.csvPath = path.string();
+        }
+
+        if (job.csvPath.empty())
+        {
+            log << "Skipping " << entry << ": no job CSV found\n";
+            ++skipped;
+            continue;
+        }
+
+        job.name = extractparentFolderName(folder.string());
+        job.outputRoot = outRoot.empty() ? folder : outRoot / job.name;
+
+        if (!roots.insert(job.outputRoot).second)
+        {
+            log << "Skipping " << entry << ": another job already writes to " << job.outputRoot.string() << "\n";
+            ++skipped;
+            continue;
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+// Runs the jobs on a pool of worker threads. Each job logs to its own
+// buffer, saved as "<job> Log.txt" in its output root and printed as one
+// block when it finishes, so logs of concurrent jobs never interleave.
+// Returns the number of jobs that failed.
+inline size_t RunDoorJobs(const std::vector<DoorJob>& jobs, unsigned int threads)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (threads > jobs.size())
+        threads = static_cast<unsigned int>(jobs.size());
+
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> failed = 0;
+    std::mutex printMutex;
+
+    auto worker = [&]
+        {
+            for (size_t i = next++; i < jobs.size(); i = next++)
+            {
+                const DoorJob& job = jobs[i];
+                std::ostringstream log;
+                log << job.name << "\n";
+
+                bool ok = false;
+                try
+                {
+                    ok = RunDoorJob(job, log);
+                }
+                catch (const std::exception& e)
+                {
+                    log << "Job failed: " << e.what() << "\n";
+                }
+
+                if (!ok)
+                    ++failed;
+
+                std::error_code ec;
+                if (std::filesystem::is_directory(job.outputRoot, ec))
+                {
+                    std::ofstream file(job.outputRoot / (job.name + " Log.txt"));
+                    file << log.str();
+                }
+
+                std::lock_guard<std::mutex> lock(printMutex);
+                std::cout << "==== " << job.name << " (" << job.csvPath << ") "
+                    << (ok ? "done" : "FAILED") << " ====\n" << log.str() << "\n";
+            }
+        };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned int t = 0; t < threads; ++t)
+        workers.emplace_back(worker);
+    for (auto& w : workers)
+        w.join();
+
+    return failed;
+}
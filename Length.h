@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>  // int64_t
+#include <compare>  // operator<=>
+
+// A length in inches, held as a whole number of ticks so that adding,
+// subtracting and scaling lengths is exact and equal lengths compare equal.
+//
+// A tick is 1/640000": 640000 = 2^10 * 5^4, so every binary fraction down to
+// 1/1024" and every decimal down to 0.0001" is a whole number of ticks, and
+// CSV dimensions such as 14.9375 or 2.35 convert without error. Only
+// division (splitting a panel between mid rails) rounds, to the nearest tick.
+class Length
+{
+public:
+    static constexpr int64_t TicksPerInch = 640000;
+
+    constexpr Length() = default;
+
+    static constexpr Length FromTicks(int64_t ticks)
+    {
+        Length length;
+        length.m_ticks = ticks;
+        return length;
+    }
+
+    // Largest length, either way, that FromInches accepts from a CSV or a
+    // definition file. Far beyond any door, and far enough inside the tick
+    // range that the sums and Round(10000) of such lengths cannot overflow.
+    static constexpr double MaxInches = 1.0e6;
+
+    // False for NaN, the infinities and anything beyond MaxInches, which
+    // FromInches cannot convert
+    static constexpr bool InRange(double inches) { return inches >= -MaxInches && inches <= MaxInches; }
+
+    // Rounds to the nearest tick. inches must be InRange.
+    static constexpr Length FromInches(double inches)
+    {
+        const double scaled = inches * TicksPerInch;
+        return FromTicks(static_cast<int64_t>(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5));
+    }
+
+    constexpr int64_t Ticks() const { return m_ticks; }
+    constexpr double Inches() const { return static_cast<double>(m_ticks) / TicksPerInch; }
+
+    // Number of 1/denom" steps nearest to this length, halves rounded away
+    // from zero
+    constexpr int64_t Round(int64_t denom) const { return DivideRounded(m_ticks * denom, TicksPerInch); }
+    // The same with halves rounded to the even step, as printf and
+    // std::to_chars round a double that lies exactly halfway
+    constexpr int64_t RoundHalfEven(int64_t denom) const
+    {
+        const int64_t num = m_ticks * denom;
+        const int64_t magnitude = num < 0 ? -num : num;
+        int64_t steps = magnitude / TicksPerInch;
+        const int64_t rest = magnitude % TicksPerInch;
+        if (rest * 2 > TicksPerInch || (rest * 2 == TicksPerInch && steps % 2 != 0))
+            ++steps;
+        return num < 0 ? -steps : steps;
+    }
+
+    constexpr Length operator-() const { return FromTicks(-m_ticks); }
+    constexpr Length& operator+=(Length other) { m_ticks += other.m_ticks; return *this; }
+    constexpr Length& operator-=(Length other) { m_ticks -= other.m_ticks; return *this; }
+
+    friend constexpr Length operator+(Length a, Length b) { return FromTicks(a.m_ticks + b.m_ticks); }
+    friend constexpr Length operator-(Length a, Length b) { return FromTicks(a.m_ticks - b.m_ticks); }
+    friend constexpr Length operator*(Length a, int64_t n) { return FromTicks(a.m_ticks * n); }
+    friend constexpr Length operator*(int64_t n, Length a) { return FromTicks(a.m_ticks * n); }
+    // Rounds to the nearest tick
+    friend constexpr Length operator/(Length a, int64_t n) { return FromTicks(DivideRounded(a.m_ticks, n)); }
+
+    friend constexpr auto operator<=>(const Length& a, const Length& b) = default;
+    friend constexpr bool operator==(const Length& a, const Length& b) = default;
+
+private:
+    static constexpr int64_t DivideRounded(int64_t num, int64_t den)
+    {
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+        return num < 0 ? -((-num + den / 2) / den) : (num + den / 2) / den;
+    }
+
+    int64_t m_ticks = 0;
+};
+
+// Odd 32nds fall halfway between two 0.0001" steps
+static_assert(Length::FromInches(0.03125).RoundHalfEven(10000) == 312);
+static_assert(Length::FromInches(0.15625).RoundHalfEven(10000) == 1562);
+static_assert(Length::FromInches(23.15625).RoundHalfEven(10000) == 231562);
+static_assert(Length::FromInches(-23.15625).RoundHalfEven(10000) == -231562);
+static_assert(Length::FromInches(0.09375).RoundHalfEven(10000) == 938);
+static_assert(Length::FromInches(0.03125).Round(32) == 1);
@@ -1,49 +1,170 @@
 ﻿#include <iostream>
 #include <string>
-#include "Windows.h"
+#include <filesystem>
 #include "Door.h"
 #include "CsvUtils.h"
+#include "Platform.h"
+#include "FileDialog.h"
+#include "JobRunner.h"
+#include "Bench.h"
 
-int main()
+struct Options
 {
-    char cwd[MAX_PATH];
-    GetCurrentDirectoryA(MAX_PATH, cwd);
-    std::string jobName = extractparentFolderName(cwd);
-    std::cout << jobName << "\n";
+    std::string csvPath;
+    std::string jobName;
+    std::string outDir;
+    std::string benchCsv;
+    std::string batchList;
+    std::string stylesPath;
+    std::string rulesPath;
+    unsigned int threads = 0;
+    bool consolidate = false;
+    bool arenaStats = false;
+    bool benchFormat = false;
+};
 
-    std::string csvPath = CsvFileDialog::Open();
-    if (csvPath.empty())
+static void PrintUsage()
+{
+    std::cout << "usage: door --csv <file.csv> [--job <name>] [--out <dir>] [--threads <n>]\n"
+        << "       door --batch <jobs.txt> [--out <dir>] [--threads <n>]\n"
+        << "       door --bench-csv <file.csv>\n"
+        << "       door --bench-format\n"
+        << "  --job defaults to the name of the working directory's parent folder\n"
+        << "  --out defaults to the working directory\n"
+        << "  --batch runs every job folder or CSV listed in jobs.txt (one per line)\n"
+        << "    concurrently; each job writes to its own folder, or to <dir>/<job> with --out\n"
+        << "  --threads is how many jobs of a batch run at once, or how many threads draw\n"
+        << "    the door report of a single job; 0 (the default) is one per core\n"
+        << "  --styles <file> adds the door styles defined in file to Slab, Shaker and Small_Shaker\n"
+        << "  --rules <file> sets the validation limits (minimum panel size, oversize limits) from file\n"
+        << "  --consolidate writes one report block per set of identical doors, listing their labels\n"
+        << "  --arena-stats logs how many heap allocations each job's memory arena saved\n";
+#ifdef DOOR_HAS_FILE_DIALOG
+    std::cout << "Without --csv the CSV is picked in a file dialog.\n";
+#endif
+}
+
+static bool ParseArgs(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
     {
-        std::cout << "No file selected\n";
-        return 0;
+        const std::string arg = argv[i];
+        if (arg == "--consolidate")
+        {
+            options.consolidate = true;
+            continue;
+        }
+        if (arg == "--arena-stats")
+        {
+            options.arenaStats = true;
+            continue;
+        }
+        if (arg == "--bench-format")
+        {
+            options.benchFormat = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+
+        if (arg == "--csv")
+            options.csvPath = argv[++i];
+        else if (arg == "--job")
+            options.jobName = argv[++i];
+        else if (arg == "--out")
+            options.outDir = argv[++i];
+        else if (arg == "--bench-csv")
+            options.benchCsv = argv[++i];
+        else if (arg == "--batch")
+            options.batchList = argv[++i];
+        else if (arg == "--styles")
+            options.stylesPath = argv[++i];
+        else if (arg == "--rules")
+            options.rulesPath = argv[++i];
+        else if (arg == "--threads")
+        {
+            if (!ParseUInt(argv[++i], options.threads))
+                return false;
+        }
+        else
+            return false;
     }
+    return true;
+}
 
-    CsvTable doortable = CsvReader::Read(csvPath);
-    DoorList doorlist(doortable);
-    doorlist.WriteHTMLReport(jobName.c_str());
-    if (doorlist.HasShaker())
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseArgs(argc, argv, options))
     {
-        doorlist.WriteTigerStopCsvs(jobName);
-        doorlist.WriteShakerLabelCsv(jobName);
+        PrintUsage();
+        return 2;
     }
-    doorlist.WriteSlabLabelCsv(jobName);
-    doorlist.WritePanelCsvs(jobName);
-    //doorlist.Print();
-    doorlist.OverSize_SanityCheck();
-    
-    double linearfootage = doorlist.GetTotalLinearFootage();
-    double bonedetaillinearfootage = doorlist.GetTotalLinearFootageBoneDetail();
-    if(linearfootage > 0.1)
+
+    // Styles are registered before any door is read
+    if (!options.stylesPath.empty() && !StyleRegistry::Global().LoadFile(options.stylesPath, std::cout))
+        return 1;
+    if (!options.rulesPath.empty() && !ValidationRules::Global().LoadFile(options.rulesPath, std::cout))
+        return 1;
+
+    if (!options.benchCsv.empty())
     {
-        std::cout << "Linear Footage of Rails and Stiles: " << linearfootage << "\n";
+        Bench::RunCsvScanBenchmark(options.benchCsv);
+        return 0;
     }
-    if (bonedetaillinearfootage > 0.1)
+    if (options.benchFormat)
     {
-        std::cout << "Linear Footage of Bone Detail: " << bonedetaillinearfootage << "\n";
+        Bench::RunFormatBenchmark();
+        return 0;
     }
 
-    return 0;
-}
+    if (!options.batchList.empty())
+    {
+        size_t skipped = 0;
+        std::vector<DoorJob> jobs = ReadJobList(options.batchList, options.outDir, std::cout, skipped);
+        for (auto& job : jobs)
+        {
+            job.consolidatedReport = options.consolidate;
+            job.reportArena = options.arenaStats;
+        }
+        const size_t failed = RunDoorJobs(jobs, options.threads) + skipped;
+        const size_t total = jobs.size() + skipped;
+        std::cout << (total - failed) << " of " << total << " job(s) done\n";
+        return failed == 0 ? 0 : 1;
+    }
+
+#ifndef DOOR_HAS_FILE_DIALOG
+    if (options.csvPath.empty())
+    {
+        PrintUsage();
+        return 2;
+    }
+#endif
 
+    std::string jobName = options.jobName;
+    if (jobName.empty())
+        jobName = extractparentFolderName(Platform::CurrentDirectory());
+    std::cout << jobName << "\n";
 
+    std::string csvPath = options.csvPath;
+#ifdef DOOR_HAS_FILE_DIALOG
+    if (csvPath.empty())
+    {
+        csvPath = CsvFileDialog::Open();
+        if (csvPath.empty())
+        {
+            std::cout << "No file selected\n";
+            return 0;
+        }
+    }
+#endif
 
+    DoorJob job;
+    job.csvPath = csvPath;
+    job.name = jobName;
+    job.outputRoot = options.outDir;
+    job.consolidatedReport = options.consolidate;
+    job.reportArena = options.arenaStats;
+    job.reportThreads = options.threads;
+    return RunDoorJob(job, std::cout) ? 0 : 1;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>       // std::string
+#include <ctime>        // std::tm, std::time_t, localtime_r
+#include <filesystem>   // std::filesystem::current_path
+
+// The few OS services the core needs, behind one interface so it builds
+// with MSVC as well as GCC and Clang.
+namespace Platform
+{
+    inline std::tm LocalTime(std::time_t t)
+    {
+        std::tm tm {};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        return tm;
+    }
+
+    // Empty if the working directory cannot be determined
+    inline std::string CurrentDirectory()
+    {
+        std::error_code ec;
+        std::filesystem::path cwd = std::filesystem::current_path(ec);
+        return ec ? std::string() : cwd.string();
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <span>         // std::span
+#include <cstdint>      // uint64_t, uint32_t
+#include <cstring>      // std::memcmp
+#include <fstream>      // std::ofstream
+#include <filesystem>   // std::filesystem::last_write_time
+#include <type_traits>  // std::is_trivially_copyable_v
+#include "MappedFile.h"
+
+// Binary snapshots of parsed records, written next to their source file.
+//
+// Layout: a SnapshotHeader, padding up to recordsOffset, then recordCount
+// records stored exactly as they are in memory. A snapshot is only used
+// while its source file still has the size, modification time and content
+// hash it was written from, and only by a build with the same record layout;
+// records are then read straight out of the mapping.
+namespace Snapshot
+{
+    // Identifies the source file a snapshot was made from
+    struct SourceStamp
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+    };
+
+    struct SnapshotHeader
+    {
+        char magic[8] = { 'D', 'O', 'O', 'R', 'S', 'N', 'A', 'P' };
+        uint32_t version = 0;        // bumped by the caller when its record changes
+        uint32_t recordSize = 0;     // sizeof(T) of the writing build
+        uint32_t recordAlign = 0;
+        uint32_t reserved = 0;
+        SourceStamp source;
+        uint64_t recordCount = 0;
+        uint64_t recordsOffset = 0;
+    };
+
+    constexpr uint64_t HashSeed = 14695981039346656037ull;
+
+    // FNV-1a, 64-bit. Pass the previous result as seed to hash several
+    // pieces as one.
+    inline uint64_t HashBytes(std::string_view bytes, uint64_t hash = HashSeed)
+    {
+        for (unsigned char c : bytes)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Size and mtime come from the file system, the hash from the mapped
+    // bytes. Returns false if the file cannot be read.
+    inline bool StampSource(const std::string& path, SourceStamp& stamp)
+    {
+        std::error_code ec;
+        auto written = std::filesystem::last_write_time(path, ec);
+        if (ec)
+            return false;
+
+        MappedFile file(path);
+        if (!file.IsOpen())
+            return false;
+
+        stamp.size = file.Size();
+        stamp.mtime = static_cast<int64_t>(written.time_since_epoch().count());
+        stamp.hash = HashBytes(file.Text());
+        return true;
+    }
+
+    inline std::string PathFor(const std::string& sourcePath)
+    {
+        return sourcePath + ".snapshot";
+    }
+
+    // Writes through a temporary file so an interrupted run never leaves a
+    // truncated snapshot behind. Returns false if it could not be written.
+    template <typename T>
+    bool Write(const std::string& path, uint32_t version, const SourceStamp& source, std::span<const T> records)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot records are stored as raw bytes");
+
+        SnapshotHeader header;
+        header.version = version;
+        header.recordSize = static_cast<uint32_t>(sizeof(T));
+        header.recordAlign = static_cast<uint32_t>(alignof(T));
+        header.source = source;
+        header.recordCount = records.size();
+        header.recordsOffset = (sizeof(SnapshotHeader) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+        const std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            const char padding[alignof(T)] = {};
+            out.write(padding, static_cast<std::streamsize>(header.recordsOffset - sizeof(header)));
+            out.write(reinterpret_cast<const char*>(records.data()),
+                static_cast<std::streamsize>(records.size_bytes()));
+            if (!out)
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    // Maps the snapshot and returns its records if it was written by this
+    // layout version from the source described by stamp; otherwise returns
+    // an empty span and leaves file closed. The records live in file.
+    template <typename T>
+    std::span<const T> Map(const std::string& path, uint32_t version, const SourceStamp& source, MappedFile& file)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot records are stored as raw bytes");
+
+        if (!file.Open(path) || file.Size() < sizeof(SnapshotHeader))
+        {
+            file.Close();
+            return {};
+        }
+
+        // MapViewOfFile and mmap return page-aligned views
+        const auto& header = *reinterpret_cast<const SnapshotHeader*>(file.Data());
+        const SnapshotHeader expected;
+
+        const bool valid =
+            std::memcmp(header.magic, expected.magic, sizeof(expected.magic)) == 0 &&
+            header.version == version &&
+            header.recordSize == sizeof(T) &&
+            header.recordAlign == alignof(T) &&
+            header.source.size == source.size &&
+            header.source.mtime == source.mtime &&
+            header.source.hash == source.hash &&
+            header.recordsOffset % alignof(T) == 0 &&
+            header.recordsOffset <= file.Size() &&
+            header.recordCount <= (file.Size() - header.recordsOffset) / sizeof(T);
+
+        if (!valid)
+        {
+            file.Close();
+            return {};
+        }
+
+        const T* records = reinterpret_cast<const T*>(file.Data() + header.recordsOffset);
+        return { records, static_cast<size_t>(header.recordCount) };
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>        // std::string
+#include <string_view>   // std::string_view
+#include <vector>        // std::vector
+#include <unordered_map> // std::unordered_map
+#include <functional>    // std::hash, std::equal_to
+#include <algorithm>     // std::sort
+#include <numeric>       // std::iota
+#include <cstdint>       // uint32_t
+
+// Interns repeated text such as door materials. Every distinct string gets
+// a dense ID, counting up from 0 in the order the strings are first seen,
+// so callers can group and route on integers (or index plain vectors with
+// them) and only look the text up again when it is written out.
+class StringTable
+{
+public:
+    uint32_t Intern(std::string_view text)
+    {
+        auto found = m_ids.find(text);
+        if (found != m_ids.end())
+            return found->second;
+
+        const uint32_t id = static_cast<uint32_t>(m_strings.size());
+        m_strings.emplace_back(text);
+        m_ids.emplace(m_strings.back(), id);
+        return id;
+    }
+
+    // Looks text up without interning it; returns false if it was never seen
+    bool Find(std::string_view text, uint32_t& id) const
+    {
+        auto found = m_ids.find(text);
+        if (found == m_ids.end())
+            return false;
+        id = found->second;
+        return true;
+    }
+
+    const std::string& operator[](uint32_t id) const { return m_strings[id]; }
+    size_t Size() const { return m_strings.size(); }
+
+    // Every ID, ordered as their strings compare; walking this visits
+    // groups in the same order a std::map keyed by the text would.
+    std::vector<uint32_t> SortedIds() const
+    {
+        std::vector<uint32_t> ids(m_strings.size());
+        std::iota(ids.begin(), ids.end(), 0u);
+        std::sort(ids.begin(), ids.end(), [this](uint32_t a, uint32_t b) { return m_strings[a] < m_strings[b]; });
+        return ids;
+    }
+
+private:
+    struct Hash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+    };
+
+    std::vector<std::string> m_strings;
+    std::unordered_map<std::string, uint32_t, Hash, std::equal_to<>> m_ids;
+};